@@ -1,3 +1,26 @@
 // Copyright (c) Giammarco Agazzotti
 
-#include "FightingCharacterAnimInstance.h"
\ No newline at end of file
+#include "FightingCharacterAnimInstance.h"
+
+void UFightingCharacterAnimInstance::NativeInitializeAnimation()
+{
+	Super::NativeInitializeAnimation();
+
+	OnMontageStarted.AddUniqueDynamic( this, &UFightingCharacterAnimInstance::OnMontageStartedInternal );
+}
+
+void UFightingCharacterAnimInstance::NativeUpdateAnimation( float DeltaSeconds )
+{
+	Super::NativeUpdateAnimation( DeltaSeconds );
+
+	if( m_StartedMontage )
+	{
+		m_MontageFirstFrameDelegate.Broadcast( m_StartedMontage );
+		m_StartedMontage = nullptr;
+	}
+}
+
+void UFightingCharacterAnimInstance::OnMontageStartedInternal( UAnimMontage* Montage )
+{
+	m_StartedMontage = Montage;
+}
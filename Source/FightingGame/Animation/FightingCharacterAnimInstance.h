@@ -17,6 +17,7 @@ enum class EMontageEventType : uint8
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams( FMontageEvent, UAnimMontage*, Montage, EMontageEventType, EventType );
+DECLARE_MULTICAST_DELEGATE_OneParam( FMontageFirstFrame, UAnimMontage* );
 
 UCLASS()
 class FIGHTINGGAME_API UFightingCharacterAnimInstance : public UAnimInstance
@@ -29,4 +30,20 @@ public:
 
 	UPROPERTY( BlueprintAssignable, BlueprintCallable, DisplayName = "Montage Event" )
 	FMontageEvent m_MontageEvent;
+
+	/*
+	 * Broadcast on the first animation update after a montage started playing
+	 */
+	FMontageFirstFrame m_MontageFirstFrameDelegate;
+
+protected:
+	virtual void NativeInitializeAnimation() override;
+	virtual void NativeUpdateAnimation( float DeltaSeconds ) override;
+
+private:
+	UPROPERTY()
+	TObjectPtr<UAnimMontage> m_StartedMontage = nullptr;
+
+	UFUNCTION()
+	void OnMontageStartedInternal( UAnimMontage* Montage );
 };
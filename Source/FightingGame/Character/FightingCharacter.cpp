@@ -1,5 +1,6 @@
 #include "FightingCharacter.h"
 #include "FSM.h"
+#include "FightingGame/Animation/FightingCharacterAnimInstance.h"
 #include "FightingGame/Common/FSMStatics.h"
 #include "FightingGame/Input/MovesBufferComponent.h"
 #include "FightingGame/Combat/HitboxHandlerComponent.h"
@@ -123,6 +124,11 @@ void AFightingCharacter::BeginPlay()
 
     m_MovesBuffer->m_OwnerCharacter = this;
 
+    if( UFightingCharacterAnimInstance* animInstance = Cast<UFightingCharacterAnimInstance>( GetMesh()->GetAnimInstance() ) )
+    {
+        animInstance->m_MontageFirstFrameDelegate.AddUObject( m_MovesBuffer.Get(), &UMovesBufferComponent::OnMontageFirstFrame );
+    }
+
     UFSMStatics::Init( m_FSM, m_FirstState );
 
     m_HitDelegateHandle = m_HitboxHandler->m_HitDelegate.AddUObject( this, &AFightingCharacter::OnHitLanded );
@@ -206,6 +212,16 @@ void AFightingCharacter::SetAirKnockbackHappening( bool Value )
     m_IsAirKnockbackHappening = Value;
 }
 
+void AFightingCharacter::SetPlayerIndex( int32 PlayerIndex )
+{
+    m_PlayerIndex = PlayerIndex;
+
+    if( m_MovesBuffer )
+    {
+        m_MovesBuffer->OnPlayerIndexChanged();
+    }
+}
+
 void AFightingCharacter::PushTimeDilation( float Value )
 {
     m_TimeDilations.Push( Value );
@@ -12,6 +12,7 @@ class UBoxComponent;
 class UHitStopComponent;
 class UFSM;
 class UMovesBufferComponent;
+class UMoveDataAsset;
 class UHitboxHandlerComponent;
 
 DECLARE_MULTICAST_DELEGATE( FFacingChanged )
@@ -66,6 +67,12 @@ public:
     UFUNCTION( BlueprintCallable )
     UHitboxHandlerComponent* GetHitboxHandler() const { return m_HitboxHandler; }
 
+    /*
+     * Last move executed, its montage may have ended since
+     */
+    FORCEINLINE UMoveDataAsset* GetCurrentMove() const { return m_CurrentMove; }
+    FORCEINLINE void SetCurrentMove( UMoveDataAsset* Move ) { m_CurrentMove = Move; }
+
     float GetKnockbackMultiplier() const;
     float GetDamagePercent() const;
     void SetDamagePercent( float Percent );
@@ -99,6 +106,11 @@ public:
     FORCEINLINE void SetOpponentToFace( TObjectPtr<AFightingCharacter> Opponent ) { m_OpponentToFace = Opponent; }
     FORCEINLINE TObjectPtr<AFightingCharacter> GetOpponentToFace() const { return m_OpponentToFace; }
 
+    /*
+     * The input manager processes the players by ascending index, it is told when the index changes
+     */
+    void SetPlayerIndex( int32 PlayerIndex );
+
     void UpdateMeshShake();
     void ResetMeshRelativeLocation();
 
@@ -121,6 +133,9 @@ protected:
     UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Projectile Spawner Component" )
     TObjectPtr<UProjectileSpawnerComponent> m_ProjectileSpawnerComponent = nullptr;
 
+    UPROPERTY()
+    TObjectPtr<UMoveDataAsset> m_CurrentMove = nullptr;
+
     UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "FSM First State" )
     FName m_FirstState = "IDLE";
 
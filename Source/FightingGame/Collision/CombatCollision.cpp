@@ -0,0 +1,306 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "CombatCollision.h"
+
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+
+void FCombatCollisionWorld::ResetHurtboxes()
+{
+    m_PendingHurtboxes.Reset();
+}
+
+void FCombatCollisionWorld::AddHurtbox( UPrimitiveComponent* Component )
+{
+    AActor* owner        = Component->GetOwner();
+    const FVector center = Component->GetComponentLocation();
+
+    if( const USphereComponent* sphere = Cast<USphereComponent>( Component ) )
+    {
+        const FVector2D center2D = ToCombatPlane( center );
+        AddHurtbox( owner, Component, center2D, center2D, sphere->GetScaledSphereRadius() );
+    }
+    else if( const UCapsuleComponent* capsule = Cast<UCapsuleComponent>( Component ) )
+    {
+        const FVector halfSegment = capsule->GetUpVector() * capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+        AddHurtbox( owner, Component, ToCombatPlane( center - halfSegment ), ToCombatPlane( center + halfSegment ), capsule->GetScaledCapsuleRadius() );
+    }
+    else if( const UBoxComponent* box = Cast<UBoxComponent>( Component ) )
+    {
+        const FVector extent = box->GetScaledBoxExtent();
+
+        FVector2D halfAxes[3] =
+        {
+            ToCombatPlane( box->GetForwardVector() * extent.X ),
+            ToCombatPlane( box->GetRightVector() * extent.Y ),
+            ToCombatPlane( box->GetUpVector() * extent.Z ),
+        };
+
+        Algo::Sort( halfAxes, []( const FVector2D& A, const FVector2D& B )
+        {
+            return A.SizeSquared() > B.SizeSquared();
+        } );
+
+        // The longest side becomes the segment, shortened by the radius so the caps end on the box sides
+        const float radius          = halfAxes[1].Size();
+        const float halfLength      = halfAxes[0].Size();
+        const FVector2D halfSegment = halfLength > radius ? halfAxes[0] * ((halfLength - radius) / halfLength) : FVector2D::ZeroVector;
+        const FVector2D center2D    = ToCombatPlane( center );
+
+        AddHurtbox( owner, Component, center2D - halfSegment, center2D + halfSegment, radius );
+    }
+    else
+    {
+        const FBoxSphereBounds& bounds = Component->Bounds;
+        const FVector2D center2D       = ToCombatPlane( bounds.Origin );
+
+        AddHurtbox( owner, Component, center2D, center2D, bounds.SphereRadius );
+    }
+}
+
+void FCombatCollisionWorld::AddHurtbox( AActor* Owner, UPrimitiveComponent* Component, const FVector2D& SegmentStart, const FVector2D& SegmentEnd,
+                                        float Radius )
+{
+    FPendingHurtbox& hurtbox = m_PendingHurtboxes.Emplace_GetRef();
+    hurtbox.m_Owner          = Owner;
+    hurtbox.m_Component      = Component;
+    hurtbox.m_SegmentStart   = SegmentStart;
+    hurtbox.m_SegmentEnd     = SegmentEnd;
+    hurtbox.m_Radius         = Radius;
+    hurtbox.m_MinY           = FMath::Min( SegmentStart.X, SegmentEnd.X ) - Radius;
+}
+
+void FCombatCollisionWorld::FinalizeHurtboxes()
+{
+    m_PendingHurtboxes.StableSort( []( const FPendingHurtbox& A, const FPendingHurtbox& B )
+    {
+        return A.m_MinY < B.m_MinY;
+    } );
+
+    const int32 numHurtboxes = m_PendingHurtboxes.Num();
+
+    m_MinY.SetNumUninitialized( numHurtboxes, false );
+    m_MaxY.SetNumUninitialized( numHurtboxes, false );
+    m_StartY.SetNumUninitialized( numHurtboxes, false );
+    m_StartZ.SetNumUninitialized( numHurtboxes, false );
+    m_DeltaY.SetNumUninitialized( numHurtboxes, false );
+    m_DeltaZ.SetNumUninitialized( numHurtboxes, false );
+    m_InvLengthSquared.SetNumUninitialized( numHurtboxes, false );
+    m_Radius.SetNumUninitialized( numHurtboxes, false );
+    m_Components.SetNumUninitialized( numHurtboxes, false );
+    m_Owners.SetNumUninitialized( numHurtboxes, false );
+
+    m_MaxWidth = 0.f;
+
+    for( int32 i = 0; i < numHurtboxes; ++i )
+    {
+        const FPendingHurtbox& hurtbox = m_PendingHurtboxes[i];
+        const FVector2D delta          = hurtbox.m_SegmentEnd - hurtbox.m_SegmentStart;
+        const float lengthSquared      = delta.SizeSquared();
+
+        m_MinY[i]             = hurtbox.m_MinY;
+        m_MaxY[i]             = FMath::Max( hurtbox.m_SegmentStart.X, hurtbox.m_SegmentEnd.X ) + hurtbox.m_Radius;
+        m_StartY[i]           = hurtbox.m_SegmentStart.X;
+        m_StartZ[i]           = hurtbox.m_SegmentStart.Y;
+        m_DeltaY[i]           = delta.X;
+        m_DeltaZ[i]           = delta.Y;
+        m_InvLengthSquared[i] = lengthSquared > SMALL_NUMBER ? 1.f / lengthSquared : 0.f;
+        m_Radius[i]           = hurtbox.m_Radius;
+        m_Components[i]       = hurtbox.m_Component;
+        m_Owners[i]           = hurtbox.m_Owner;
+
+        m_MaxWidth = FMath::Max( m_MaxWidth, m_MaxY[i] - m_MinY[i] );
+    }
+}
+
+bool FCombatCollisionWorld::OverlapCircle( const FVector2D& Center, float Radius, TConstArrayView<const AActor*> ActorsToIgnore, FCombatOverlap& OutOverlap ) const
+{
+    const float minY = Center.X - Radius;
+    const float maxY = Center.X + Radius;
+
+    // Sorted by min Y, nothing starting before minY - m_MaxWidth can reach the circle
+    const int32 firstHurtboxIdx = Algo::LowerBound( m_MinY, minY - m_MaxWidth );
+
+    OutOverlap = FCombatOverlap();
+
+    for( int32 i = firstHurtboxIdx; i < m_MinY.Num() && m_MinY[i] <= maxY; ++i )
+    {
+        if( m_MaxY[i] < minY )
+        {
+            continue;
+        }
+
+        // Closest point of the segment to the center, a zero length segment has a zero inverse length so t stays 0
+        const float toCenterY = Center.X - m_StartY[i];
+        const float toCenterZ = Center.Y - m_StartZ[i];
+        const float t         = FMath::Clamp( (toCenterY * m_DeltaY[i] + toCenterZ * m_DeltaZ[i]) * m_InvLengthSquared[i], 0.f, 1.f );
+
+        const float offsetY         = toCenterY - m_DeltaY[i] * t;
+        const float offsetZ         = toCenterZ - m_DeltaZ[i] * t;
+        const float distanceSquared = offsetY * offsetY + offsetZ * offsetZ;
+        const float reach           = m_Radius[i] + Radius;
+
+        if( distanceSquared > reach * reach || ActorsToIgnore.Contains( m_Owners[i] ) )
+        {
+            continue;
+        }
+
+        const float depth = reach - FMath::Sqrt( distanceSquared );
+        if( OutOverlap.m_HurtboxIdx == INDEX_NONE || depth > OutOverlap.m_Depth )
+        {
+            OutOverlap.m_HurtboxIdx  = i;
+            OutOverlap.m_Depth       = depth;
+            OutOverlap.m_ImpactPoint = FVector2D( m_StartY[i] + m_DeltaY[i] * t, m_StartZ[i] + m_DeltaZ[i] * t );
+        }
+    }
+
+    return OutOverlap.m_HurtboxIdx != INDEX_NONE;
+}
+
+bool FCombatCollisionWorld::SweepCircle( const FVector2D& Start, const FVector2D& End, float Radius, TConstArrayView<const AActor*> ActorsToIgnore,
+                                         FCombatOverlap& OutOverlap ) const
+{
+    const FVector2D delta = End - Start;
+    if( delta.IsNearlyZero() )
+    {
+        return OverlapCircle( End, Radius, ActorsToIgnore, OutOverlap );
+    }
+
+    const float minY = FMath::Min( Start.X, End.X ) - Radius;
+    const float maxY = FMath::Max( Start.X, End.X ) + Radius;
+
+    const int32 firstHurtboxIdx = Algo::LowerBound( m_MinY, minY - m_MaxWidth );
+
+    OutOverlap = FCombatOverlap();
+
+    for( int32 i = firstHurtboxIdx; i < m_MinY.Num() && m_MinY[i] <= maxY; ++i )
+    {
+        if( m_MaxY[i] < minY )
+        {
+            continue;
+        }
+
+        const FVector2D startPoint = GetClosestPoint( i, Start );
+        const float reach          = m_Radius[i] + Radius;
+
+        float time = 0.f;
+        if( FVector2D::DistSquared( Start, startPoint ) > reach * reach && !SweepHurtbox( i, Start, delta, Radius, time ) )
+        {
+            continue;
+        }
+
+        if( ActorsToIgnore.Contains( m_Owners[i] ) || (OutOverlap.m_HurtboxIdx != INDEX_NONE && time > OutOverlap.m_Time) )
+        {
+            continue;
+        }
+
+        const FVector2D center      = Start + delta * time;
+        const FVector2D impactPoint = time > 0.f ? GetClosestPoint( i, center ) : startPoint;
+        const float depth           = FMath::Max( reach - FVector2D::Distance( center, impactPoint ), 0.f );
+
+        if( OutOverlap.m_HurtboxIdx == INDEX_NONE || time < OutOverlap.m_Time || depth > OutOverlap.m_Depth )
+        {
+            OutOverlap.m_HurtboxIdx  = i;
+            OutOverlap.m_Depth       = depth;
+            OutOverlap.m_ImpactPoint = impactPoint;
+            OutOverlap.m_Time        = time;
+        }
+    }
+
+    return OutOverlap.m_HurtboxIdx != INDEX_NONE;
+}
+
+bool FCombatCollisionWorld::SweepHurtbox( int32 HurtboxIdx, const FVector2D& Start, const FVector2D& Delta, float Radius, float& OutTime ) const
+{
+    // Moving circle against the hurtbox capsule is a ray against the capsule inflated by the circle radius:
+    // the first hit is on one of the two sides of the segment or on one of the two end caps
+    const FVector2D segmentStart( m_StartY[HurtboxIdx], m_StartZ[HurtboxIdx] );
+    const FVector2D segment( m_DeltaY[HurtboxIdx], m_DeltaZ[HurtboxIdx] );
+    const float reach = m_Radius[HurtboxIdx] + Radius;
+
+    OutTime = BIG_NUMBER;
+
+    if( m_InvLengthSquared[HurtboxIdx] > 0.f )
+    {
+        const FVector2D normal  = FVector2D( segment.Y, -segment.X ) * FMath::Sqrt( m_InvLengthSquared[HurtboxIdx] );
+        const float startOffset = FVector2D::DotProduct( Start - segmentStart, normal );
+        const float speed       = FVector2D::DotProduct( Delta, normal );
+
+        // Only the side the circle starts on can be hit first
+        const float side = startOffset >= 0.f ? 1.f : -1.f;
+        if( speed * side < 0.f )
+        {
+            const float time = (side * reach - startOffset) / speed;
+            const float s    = FVector2D::DotProduct( Start + Delta * time - segmentStart, segment ) * m_InvLengthSquared[HurtboxIdx];
+
+            if( time >= 0.f && time <= 1.f && s >= 0.f && s <= 1.f )
+            {
+                OutTime = time;
+            }
+        }
+    }
+
+    const FVector2D caps[2] = { segmentStart, segmentStart + segment };
+    const float a           = Delta.SizeSquared();
+
+    for( const FVector2D& cap : caps )
+    {
+        const FVector2D toStart  = Start - cap;
+        const float b            = FVector2D::DotProduct( toStart, Delta );
+        const float c            = toStart.SizeSquared() - reach * reach;
+        const float discriminant = b * b - a * c;
+
+        if( b < 0.f && discriminant >= 0.f )
+        {
+            const float time = (-b - FMath::Sqrt( discriminant )) / a;
+            if( time <= 1.f )
+            {
+                OutTime = FMath::Min( OutTime, FMath::Max( time, 0.f ) );
+            }
+        }
+    }
+
+    return OutTime <= 1.f;
+}
+
+FVector2D FCombatCollisionWorld::GetClosestPoint( int32 HurtboxIdx, const FVector2D& Point ) const
+{
+    const float toPointY = Point.X - m_StartY[HurtboxIdx];
+    const float toPointZ = Point.Y - m_StartZ[HurtboxIdx];
+    const float t        = FMath::Clamp( (toPointY * m_DeltaY[HurtboxIdx] + toPointZ * m_DeltaZ[HurtboxIdx]) * m_InvLengthSquared[HurtboxIdx], 0.f, 1.f );
+
+    return FVector2D( m_StartY[HurtboxIdx] + m_DeltaY[HurtboxIdx] * t, m_StartZ[HurtboxIdx] + m_DeltaZ[HurtboxIdx] * t );
+}
+
+void FCombatCollisionWorld::SweepCircles( TConstArrayView<FCombatHitboxQuery> Queries, TArrayView<FCombatOverlap> OutOverlaps ) const
+{
+    check( Queries.Num() == OutOverlaps.Num() );
+
+    const EParallelForFlags flags = Queries.Num() < s_MinParallelQueries ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+
+    ParallelFor( Queries.Num(), [&]( int32 _queryIdx )
+    {
+        const FCombatHitboxQuery& query = Queries[_queryIdx];
+        SweepCircle( query.m_PreviousCenter, query.m_Center, query.m_Radius, query.m_ActorsToIgnore, OutOverlaps[_queryIdx] );
+    }, flags );
+}
+
+FHitResult FCombatCollisionWorld::MakeHitResult( const FVector& Start, const FVector& End, const FCombatOverlap& Overlap ) const
+{
+    const FVector location = FMath::Lerp( Start, End, Overlap.m_Time );
+    const FVector impactPoint( location.X, Overlap.m_ImpactPoint.X, Overlap.m_ImpactPoint.Y );
+
+    FHitResult hitResult( m_Owners[Overlap.m_HurtboxIdx], m_Components[Overlap.m_HurtboxIdx], impactPoint, (location - impactPoint).GetSafeNormal() );
+    hitResult.Time              = Overlap.m_Time;
+    hitResult.Location          = location;
+    hitResult.TraceStart        = Start;
+    hitResult.TraceEnd          = End;
+    hitResult.PenetrationDepth  = Overlap.m_Depth;
+    hitResult.bStartPenetrating = Overlap.m_Time == 0.f;
+
+    return hitResult;
+}
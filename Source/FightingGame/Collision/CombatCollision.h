@@ -0,0 +1,143 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+
+class UPrimitiveComponent;
+
+/*
+ * Fighting plane coordinates: Y is horizontal, Z vertical
+ */
+FORCEINLINE FVector2D ToCombatPlane( const FVector& Location )
+{
+    return FVector2D( Location.Y, Location.Z );
+}
+
+struct FCombatOverlap
+{
+    int32 m_HurtboxIdx = INDEX_NONE;
+
+    /*
+     * How much the shapes interpenetrate, the deepest overlap wins when several hurtboxes are touched
+     */
+    float m_Depth = 0.f;
+
+    /*
+     * Point of the hurtbox closest to the hitbox center, on the fighting plane
+     */
+    FVector2D m_ImpactPoint = FVector2D::ZeroVector;
+
+    /*
+     * Fraction of the sweep at the first contact, 0 when the hitbox already overlapped at the start of the sweep
+     */
+    float m_Time = 0.f;
+};
+
+/*
+ * One hitbox of a batch, swept from its previous center to its current one. Its ignored actors are viewed in place and have to outlive the batch
+ */
+struct FCombatHitboxQuery
+{
+    FVector2D m_PreviousCenter = FVector2D::ZeroVector;
+    FVector2D m_Center         = FVector2D::ZeroVector;
+    float m_Radius             = 0.f;
+
+    TConstArrayView<const AActor*> m_ActorsToIgnore;
+};
+
+/*
+ * Hurtboxes projected on the fighting plane as capsules (a segment and a radius), a circle being a capsule with a zero length segment.
+ * They are stored in parallel arrays sorted by min Y, so an overlap query only tests the hurtboxes whose Y interval can reach its own.
+ * Components are gathered once per frame, their pointers are only meant to be used during that frame.
+ */
+class FIGHTINGGAME_API FCombatCollisionWorld
+{
+public:
+    void ResetHurtboxes();
+
+    /*
+     * Spheres and capsules are projected exactly, boxes as the capsule along their longest side in the plane, anything else as its bounds
+     */
+    void AddHurtbox( UPrimitiveComponent* Component );
+
+    /*
+     * Component is the one hit results report, null for hurtboxes that are not backed by a primitive
+     */
+    void AddHurtbox( AActor* Owner, UPrimitiveComponent* Component, const FVector2D& SegmentStart, const FVector2D& SegmentEnd, float Radius );
+
+    /*
+     * Sorts the hurtboxes added since the last reset, call before querying
+     */
+    void FinalizeHurtboxes();
+
+    /*
+     * Deepest overlap between a circle and the hurtboxes whose owner is not ignored
+     */
+    bool OverlapCircle( const FVector2D& Center, float Radius, TConstArrayView<const AActor*> ActorsToIgnore, FCombatOverlap& OutOverlap ) const;
+
+    /*
+     * Earliest contact of a circle moving from Start to End (a capsule on the plane) with the hurtboxes whose owner is not ignored,
+     * the deepest one wins when several are touched at the same time. Same as OverlapCircle when the circle doesn't move
+     */
+    bool SweepCircle( const FVector2D& Start, const FVector2D& End, float Radius, TConstArrayView<const AActor*> ActorsToIgnore,
+                      FCombatOverlap& OutOverlap ) const;
+
+    /*
+     * Sweeps every query in parallel, each one writing only its own overlap, a query without overlap gets INDEX_NONE as hurtbox
+     */
+    void SweepCircles( TConstArrayView<FCombatHitboxQuery> Queries, TArrayView<FCombatOverlap> OutOverlaps ) const;
+
+    /*
+     * Hit result of an overlap as a sphere sweep from Start to End would report it
+     */
+    FHitResult MakeHitResult( const FVector& Start, const FVector& End, const FCombatOverlap& Overlap ) const;
+
+    FORCEINLINE int32 GetNumHurtboxes() const { return m_Components.Num(); }
+    FORCEINLINE UPrimitiveComponent* GetHurtboxComponent( int32 HurtboxIdx ) const { return m_Components[HurtboxIdx]; }
+    FORCEINLINE AActor* GetHurtboxOwner( int32 HurtboxIdx ) const { return m_Owners[HurtboxIdx]; }
+
+    FORCEINLINE void GetHurtboxShape( int32 HurtboxIdx, FVector2D& OutStart, FVector2D& OutEnd, float& OutRadius ) const
+    {
+        OutStart  = FVector2D( m_StartY[HurtboxIdx], m_StartZ[HurtboxIdx] );
+        OutEnd    = OutStart + FVector2D( m_DeltaY[HurtboxIdx], m_DeltaZ[HurtboxIdx] );
+        OutRadius = m_Radius[HurtboxIdx];
+    }
+
+private:
+    // Below this the task dispatch costs more than the tests
+    static constexpr int32 s_MinParallelQueries = 16;
+
+    struct FPendingHurtbox
+    {
+        AActor* m_Owner                  = nullptr;
+        UPrimitiveComponent* m_Component = nullptr;
+        FVector2D m_SegmentStart;
+        FVector2D m_SegmentEnd;
+        float m_Radius = 0.f;
+        float m_MinY   = 0.f;
+    };
+
+    TArray<FPendingHurtbox> m_PendingHurtboxes;
+
+    /*
+     * Time of impact of a circle moving by Delta from Start with a hurtbox, the circle must not overlap it at Start
+     */
+    bool SweepHurtbox( int32 HurtboxIdx, const FVector2D& Start, const FVector2D& Delta, float Radius, float& OutTime ) const;
+    FVector2D GetClosestPoint( int32 HurtboxIdx, const FVector2D& Point ) const;
+
+    // Indexed by hurtbox, sorted by min Y. Never shrunk, a frame with fewer hurtboxes doesn't give the storage back
+    TArray<float> m_MinY;
+    TArray<float> m_MaxY;
+    TArray<float> m_StartY;
+    TArray<float> m_StartZ;
+    TArray<float> m_DeltaY;
+    TArray<float> m_DeltaZ;
+    TArray<float> m_InvLengthSquared;
+    TArray<float> m_Radius;
+    TArray<UPrimitiveComponent*> m_Components;
+    TArray<AActor*> m_Owners;
+
+    float m_MaxWidth = 0.f;
+};
@@ -2,9 +2,20 @@
 
 #include "CombatManager.h"
 
+#include "EngineUtils.h"
+#include "Algo/Compare.h"
+#include "HitboxHandlerComponent.h"
+#include "FightingGame/Collision/CustomCollisionChannels.h"
+#include "FightingGame/Combat/FacingEntity.h"
+#include "FightingGame/Debugging/HitboxAllocationCounter.h"
+#include "FightingGame/Debugging/HitboxDebugRenderer.h"
+
 ACombatManager::ACombatManager()
 {
 	PrimaryActorTick.bCanEverTick = true;
+
+	// Every character moved and animated, hitboxes and hurtboxes come from the same pose
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
 }
 
 void ACombatManager::BeginPlay()
@@ -15,4 +26,288 @@ void ACombatManager::BeginPlay()
 void ACombatManager::Tick( float DeltaTime )
 {
 	Super::Tick( DeltaTime );
+
+	ResolveHitboxes();
+
+	DEBUG_DrawCombat();
+}
+
+void ACombatManager::RegisterHitboxHandler( UHitboxHandlerComponent* HitboxHandler )
+{
+	m_HitboxHandlers.AddUnique( HitboxHandler );
+}
+
+void ACombatManager::UnregisterHitboxHandler( UHitboxHandlerComponent* HitboxHandler )
+{
+	const int32 handlerIdx = m_HitboxHandlers.IndexOfByKey( HitboxHandler );
+	if( handlerIdx != INDEX_NONE )
+	{
+		m_HitboxHandlers[handlerIdx] = nullptr;
+	}
+}
+
+int32 ACombatManager::RegisterHurtboxSet( const TArray<FHurtboxDescription>& Hurtboxes )
+{
+	// States are instanced per character, the ones sharing their shapes share their set
+	const int32 existingSet = m_HurtboxSets.IndexOfByPredicate( [this, &Hurtboxes]( const FHurtboxSet& _set )
+	{
+		return Algo::Compare( TConstArrayView<FHurtboxDescription>( m_SetHurtboxes.GetData() + _set.m_FirstHurtbox, _set.m_NumHurtboxes ), Hurtboxes );
+	} );
+
+	if( existingSet != INDEX_NONE )
+	{
+		return existingSet;
+	}
+
+	const int32 firstHurtbox = m_SetHurtboxes.Num();
+	m_SetHurtboxes.Append( Hurtboxes );
+
+	return m_HurtboxSets.Emplace( FHurtboxSet{firstHurtbox, Hurtboxes.Num()} );
+}
+
+void ACombatManager::SetHurtboxSet( AActor* Owner, int32 HurtboxSet )
+{
+	check( HurtboxSet == INDEX_NONE || m_HurtboxSets.IsValidIndex( HurtboxSet ) );
+
+	const int32 ownerIdx = m_HurtboxSetOwners.IndexOfByPredicate( [Owner]( const FHurtboxSetOwner& _owner )
+	{
+		return _owner.m_Owner.Get() == Owner;
+	} );
+
+	if( HurtboxSet == INDEX_NONE )
+	{
+		if( ownerIdx != INDEX_NONE )
+		{
+			m_HurtboxSetOwners.RemoveAtSwap( ownerIdx, 1, false );
+		}
+	}
+	else if( ownerIdx != INDEX_NONE )
+	{
+		m_HurtboxSetOwners[ownerIdx].m_HurtboxSet = HurtboxSet;
+	}
+	else
+	{
+		m_HurtboxSetOwners.Emplace( FHurtboxSetOwner{Owner, HurtboxSet} );
+	}
+}
+
+void ACombatManager::ResolveHitboxes()
+{
+	FG_HITBOX_ALLOCATION_SCOPE();
+
+	m_HitboxHandlers.Remove( nullptr );
+
+	m_HitResolver.Reset();
+	m_HitboxQueries.Reset();
+
+	const bool analytic = m_CollisionMode == ECombatCollisionMode::Analytic;
+
+	// Gather, socket locations are read on the game thread. Physics traces run right away, analytic queries are batched
+	for( UHitboxHandlerComponent* handler : m_HitboxHandlers )
+	{
+		// Every character animated, each followed socket is read once for all the hitboxes using it
+		handler->RefreshSocketTransforms();
+
+		handler->ForEachActiveHitbox( [&]( FHitboxHandle _handle, FActiveHitbox& _hitbox )
+		{
+			const HitData& hit     = _hitbox.m_Hit;
+			const FVector location = handler->GetHitTraceLocation( _hitbox );
+
+			// Always advanced, so turning sweeping on doesn't sweep from a stale location
+			const FVector previousLocation = _hitbox.AdvanceSweep( location );
+			const FVector sweepStart       = m_SweptHitboxes ? previousLocation : location;
+
+			const int32 hitboxIdx = m_HitResolver.AddHitbox( handler, _handle, _hitbox.m_HitRegistryGroup, hit, sweepStart, location );
+
+			if( analytic )
+			{
+				// The ignore list is kept alive by the hitbox until the batch is over
+				FCombatHitboxQuery& query = m_HitboxQueries.Emplace_GetRef();
+				query.m_PreviousCenter    = ToCombatPlane( sweepStart );
+				query.m_Center            = ToCombatPlane( location );
+				query.m_Radius            = hit.m_Radius;
+				query.m_ActorsToIgnore    = hit.m_ActorsToIgnore->GetActors();
+			}
+			else
+			{
+				FHitResult outHit;
+				if( handler->TraceHitbox( hit, sweepStart, location, outHit ) )
+				{
+					m_HitResolver.AddCandidate( hitboxIdx, outHit );
+				}
+			}
+		} );
+	}
+
+	if( m_HitResolver.GetNumHitboxes() == 0 )
+	{
+		return;
+	}
+
+	// Test, in parallel, queries are indexed like the resolver hitboxes
+	if( analytic )
+	{
+		const FCombatCollisionWorld& collisionWorld = GetCollisionWorld();
+
+		m_HitboxOverlaps.SetNum( m_HitboxQueries.Num(), false );
+		collisionWorld.SweepCircles( m_HitboxQueries, m_HitboxOverlaps );
+
+		for( int32 hitboxIdx = 0; hitboxIdx < m_HitboxQueries.Num(); ++hitboxIdx )
+		{
+			const FCombatOverlap& overlap = m_HitboxOverlaps[hitboxIdx];
+			if( overlap.m_HurtboxIdx != INDEX_NONE )
+			{
+				const FHitResult hitResult = collisionWorld.MakeHitResult( m_HitResolver.GetHitboxSweepStart( hitboxIdx ), m_HitResolver.GetHitboxLocation( hitboxIdx ), overlap );
+				m_HitResolver.AddCandidate( hitboxIdx, hitResult );
+			}
+		}
+	}
+
+	// Best hit per group and target, clashes, then every remaining hit is applied even if a previous one ended the attacker's move
+	m_HitResolver.ResolveAndApply();
+}
+
+void ACombatManager::DEBUG_DrawCombat()
+{
+#if FG_HITBOX_DEBUG_RENDERER
+	FHitboxDebugRenderer* renderer = FHitboxDebugRenderer::Get( GetWorld() );
+	if( !renderer )
+	{
+		return;
+	}
+
+	for( UHitboxHandlerComponent* handler : m_HitboxHandlers )
+	{
+		if( handler )
+		{
+			handler->DEBUG_DrawHitboxes();
+		}
+	}
+
+	// Physics hurtboxes can be seen with the collision view mode already
+	if( m_CollisionMode != ECombatCollisionMode::Analytic )
+	{
+		return;
+	}
+
+	const FCombatCollisionWorld& collisionWorld = GetCollisionWorld();
+	for( int32 hurtboxIdx = 0; hurtboxIdx < collisionWorld.GetNumHurtboxes(); ++hurtboxIdx )
+	{
+		const AActor* owner = collisionWorld.GetHurtboxOwner( hurtboxIdx );
+		if( !owner )
+		{
+			continue;
+		}
+
+		FVector2D start;
+		FVector2D end;
+		float radius;
+		collisionWorld.GetHurtboxShape( hurtboxIdx, start, end, radius );
+
+		renderer->AddHurtbox( owner->GetActorLocation().X, start, end, radius );
+	}
+#endif
+}
+
+void ACombatManager::OnRegister( AGameFramework& Framework )
+{
+	Super::OnRegister( Framework );
+
+	for( TActorIterator<AActor> it( GetWorld() ); it; ++it )
+	{
+		RegisterHurtboxes( *it );
+	}
+
+	m_ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler( FOnActorSpawned::FDelegate::CreateUObject( this, &ACombatManager::RegisterHurtboxes ) );
+}
+
+void ACombatManager::OnDeregister( AGameFramework& Framework )
+{
+	GetWorld()->RemoveOnActorSpawnedHandler( m_ActorSpawnedHandle );
+	m_HurtboxComponents.Reset();
+
+	Super::OnDeregister( Framework );
+}
+
+const FCombatCollisionWorld& ACombatManager::GetCollisionWorld()
+{
+	if( m_CollisionWorldFrame != GFrameCounter )
+	{
+		m_CollisionWorldFrame = GFrameCounter;
+		RefreshCollisionWorld();
+	}
+
+	return m_CollisionWorld;
+}
+
+void ACombatManager::RegisterHurtboxes( AActor* Actor )
+{
+	TInlineComponentArray<UPrimitiveComponent*> primitives( Actor );
+	for( UPrimitiveComponent* primitive : primitives )
+	{
+		if( primitive->GetCollisionObjectType() == CUSTOM_TRACE_HURTBOX )
+		{
+			m_HurtboxComponents.Emplace( primitive );
+		}
+	}
+}
+
+void ACombatManager::RefreshCollisionWorld()
+{
+	m_CollisionWorld.ResetHurtboxes();
+
+	AddHurtboxSets();
+
+	for( int32 i = m_HurtboxComponents.Num() - 1; i >= 0; --i )
+	{
+		UPrimitiveComponent* hurtbox = m_HurtboxComponents[i].Get();
+		if( !hurtbox )
+		{
+			m_HurtboxComponents.RemoveAt( i, 1, false );
+			continue;
+		}
+
+		const AActor* owner = hurtbox->GetOwner();
+		const bool hasSet   = m_HurtboxSetOwners.ContainsByPredicate( [owner]( const FHurtboxSetOwner& _owner )
+		{
+			return _owner.m_Owner.Get() == owner;
+		} );
+
+		// Same filter as an object trace on the hurtbox channel, owners with a hurtbox set are only tested with it
+		if( !hasSet && hurtbox->IsQueryCollisionEnabled() && hurtbox->IsRegistered() )
+		{
+			m_CollisionWorld.AddHurtbox( hurtbox );
+		}
+	}
+
+	m_CollisionWorld.FinalizeHurtboxes();
+}
+
+void ACombatManager::AddHurtboxSets()
+{
+	for( int32 i = m_HurtboxSetOwners.Num() - 1; i >= 0; --i )
+	{
+		AActor* owner = m_HurtboxSetOwners[i].m_Owner.Get();
+		if( !owner )
+		{
+			m_HurtboxSetOwners.RemoveAtSwap( i, 1, false );
+			continue;
+		}
+
+		// Described facing right, mirrored like hitbox locations
+		IFacingEntity* facingEntity = Cast<IFacingEntity>( owner );
+		const float facing          = facingEntity && !facingEntity->IsFacingRight() ? -1.f : 1.f;
+		const FVector2D origin      = ToCombatPlane( owner->GetActorLocation() );
+
+		const FHurtboxSet& set = m_HurtboxSets[m_HurtboxSetOwners[i].m_HurtboxSet];
+		for( int32 hurtboxIdx = set.m_FirstHurtbox; hurtboxIdx < set.m_FirstHurtbox + set.m_NumHurtboxes; ++hurtboxIdx )
+		{
+			const FHurtboxDescription& hurtbox = m_SetHurtboxes[hurtboxIdx];
+
+			m_CollisionWorld.AddHurtbox( owner, nullptr,
+			                             origin + FVector2D( hurtbox.m_Start.X * facing, hurtbox.m_Start.Y ),
+			                             origin + FVector2D( hurtbox.m_End.X * facing, hurtbox.m_End.Y ),
+			                             hurtbox.m_Radius );
+		}
+	}
 }
@@ -3,10 +3,29 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "FightingGame/Collision/CombatCollision.h"
+#include "FightingGame/Combat/HitResolver.h"
+#include "FightingGame/Combat/HurtboxDescription.h"
 #include "FightingGame/Common/Manager.h"
 #include "GameFramework/Actor.h"
 #include "CombatManager.generated.h"
 
+class UHitboxHandlerComponent;
+
+UENUM()
+enum class ECombatCollisionMode : uint8
+{
+	/*
+	 * Hitboxes are tested against the hurtboxes projected on the fighting plane
+	 */
+	Analytic,
+
+	/*
+	 * Every hitbox runs a sphere trace against the hurtbox channel
+	 */
+	PhysicsTrace,
+};
+
 UCLASS()
 class FIGHTINGGAME_API ACombatManager : public AManager
 {
@@ -18,6 +37,35 @@ public:
 	FORCEINLINE float GetHitStopStartDelay() const { return m_HitStopStartDelay; }
 	FORCEINLINE float GetHitStopTimeDilation() const { return m_HitStopTimeDilation; }
 
+	FORCEINLINE ECombatCollisionMode GetCollisionMode() const { return m_CollisionMode; }
+	FORCEINLINE bool AreHitboxesSwept() const { return m_SweptHitboxes; }
+
+	/*
+	 * Hurtboxes are gathered on the first query of each frame
+	 */
+	const FCombatCollisionWorld& GetCollisionWorld();
+
+	virtual void OnRegister( AGameFramework& Framework ) override;
+	virtual void OnDeregister( AGameFramework& Framework ) override;
+
+	/*
+	 * Registered handlers stop resolving their own hitboxes, the manager tests every active hitbox of the world in one batch (in parallel
+	 * with the analytic collision) and resolves all the hits of the frame together, see FHitResolver
+	 */
+	void RegisterHitboxHandler( UHitboxHandlerComponent* HitboxHandler );
+	void UnregisterHitboxHandler( UHitboxHandlerComponent* HitboxHandler );
+
+	/*
+	 * Stores a set of data-driven hurtboxes once, registering the same shapes again returns the same index
+	 */
+	int32 RegisterHurtboxSet( const TArray<FHurtboxDescription>& Hurtboxes );
+
+	/*
+	 * The owner is tested with the shapes of the set, placed from its location and facing, instead of its hurtbox primitives.
+	 * INDEX_NONE goes back to the primitives. Only the analytic collision mode sees data-driven hurtboxes
+	 */
+	void SetHurtboxSet( AActor* Owner, int32 HurtboxSet );
+
 protected:
 	UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Hit Stop Start Delay" )
 	float m_HitStopStartDelay = 0.f;
@@ -25,8 +73,64 @@ protected:
 	UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Hit Stop Time Dilation" )
 	float m_HitStopTimeDilation = 0.001f;
 
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Collision Mode" )
+	ECombatCollisionMode m_CollisionMode = ECombatCollisionMode::Analytic;
+
+	/*
+	 * Hitboxes are traced from where they were on the previous frame to where they are now, so a fast limb can't skip through a hurtbox
+	 * between two frames. Lets the simulation tick at a lower rate without missing hits
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Swept Hitboxes" )
+	bool m_SweptHitboxes = false;
+
 	virtual void BeginPlay() override;
 
 public:
 	virtual void Tick( float DeltaTime ) override;
+
+private:
+	FCombatCollisionWorld m_CollisionWorld;
+	uint64 m_CollisionWorldFrame = MAX_uint64;
+
+	// Primitives with the hurtbox object type, registered when their actor spawns
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> m_HurtboxComponents;
+	FDelegateHandle m_ActorSpawnedHandle;
+
+	struct FHurtboxSet
+	{
+		int32 m_FirstHurtbox = 0;
+		int32 m_NumHurtboxes = 0;
+	};
+
+	struct FHurtboxSetOwner
+	{
+		TWeakObjectPtr<AActor> m_Owner;
+		int32 m_HurtboxSet = INDEX_NONE;
+	};
+
+	// Shapes of every set one after the other, a set is a range of them
+	TArray<FHurtboxSet> m_HurtboxSets;
+	TArray<FHurtboxDescription> m_SetHurtboxes;
+	TArray<FHurtboxSetOwner> m_HurtboxSetOwners;
+
+	void RegisterHurtboxes( AActor* Actor );
+	void RefreshCollisionWorld();
+	void AddHurtboxSets();
+
+	// Unregistering during the batch leaves a null entry, removed on the next one
+	UPROPERTY()
+	TArray<TObjectPtr<UHitboxHandlerComponent>> m_HitboxHandlers;
+
+	FHitResolver m_HitResolver;
+
+	// Indexed by resolver hitbox, reset every batch but never shrunk so a steady fight doesn't allocate
+	TArray<FCombatHitboxQuery> m_HitboxQueries;
+	TArray<FCombatOverlap> m_HitboxOverlaps;
+
+	void ResolveHitboxes();
+
+	/*
+	 * Queues the active hitboxes and the analytic hurtboxes in the debug renderer of the world
+	 */
+	void DEBUG_DrawCombat();
 };
@@ -2,7 +2,7 @@
 
 HitData::HitData( bool InForceOpponentFacing, float InDamagePercent, float InRadius, const FVector& InProcessedKnockback, bool InIgnoreKnockbackMultiplier,
                   float InHitStunDuration, bool InShake, UWorld* InWorld, AActor* InOwner, USkeletalMeshComponent* InSkeletalMesh, const FName& InSocketToFollow,
-                  FVector InLocation, uint32 InId, int32 InGroupId, int32 InPriority, const TArray<TObjectPtr<AActor>>& InAdditionalActorsToIgnore )
+                  FVector InLocation, uint32 InId, int32 InGroupId, int32 InPriority )
     : m_ForceOpponentFacing( InForceOpponentFacing ),
       m_DamagePercent( InDamagePercent ),
       m_Radius( InRadius ),
@@ -18,7 +18,6 @@ HitData::HitData( bool InForceOpponentFacing, float InDamagePercent, float InRad
       m_Id( InId ),
       m_GroupId( InGroupId ),
       m_Priority( InPriority ),
-      m_AdditionalActorsToIgnore( InAdditionalActorsToIgnore ),
       m_PendingRemoval( false )
 {
 }
@@ -1,5 +1,10 @@
 ﻿#pragma once
 
+#include "FightingGame/Combat/HitboxIgnoreList.h"
+
+class UAnimMontage;
+struct FBakedHitboxTrack;
+
 // #TODO this should become a USTRUCT i think
 struct HitData
 {
@@ -18,24 +23,15 @@ struct HitData
     uint32 m_Id;
     int32 m_GroupId;
     int32 m_Priority;
-    TArray<TObjectPtr<AActor>> m_AdditionalActorsToIgnore;
+    TSharedPtr<const FHitboxIgnoreList> m_ActorsToIgnore; // Shared by the hitboxes of a handler, set when the hitbox is added
+    const FBakedHitboxTrack* m_BakedTrack = nullptr;      // Followed instead of the socket when set, sampled at the position of m_BakedMontage
+    const UAnimMontage* m_BakedMontage    = nullptr;
     bool m_PendingRemoval;
 
     explicit HitData( bool InForceOpponentFacing, float InDamagePercent, float InRadius, const FVector& InProcessedKnockback, bool InIgnoreKnockbackMultiplier,
                       float InHitStunDuration, bool InShake, UWorld* InWorld, AActor* InOwner, USkeletalMeshComponent* InSkeletalMesh,
                       const FName& InSocketToFollow,
-                      FVector InLocation, uint32 InId, int32 InGroupId, int32 InPriority, const TArray<TObjectPtr<AActor>>& InAdditionalActorsToIgnore );
-
-    void GetActorsToIgnore( TArray<TObjectPtr<AActor>>& OutActors ) const
-    {
-        OutActors.Reset();
-
-        OutActors.Emplace( m_Owner );
-        for( int32 i = 0; i < m_AdditionalActorsToIgnore.Num(); ++i )
-        {
-            OutActors.Emplace( m_AdditionalActorsToIgnore[i] );
-        }
-    }
+                      FVector InLocation, uint32 InId, int32 InGroupId, int32 InPriority );
 
     friend bool operator==( const HitData& Lhs, const HitData& RHS );
     friend bool operator!=( const HitData& Lhs, const HitData& RHS );
@@ -0,0 +1,67 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HitRegistry.h"
+
+int32 FHitRegistry::AcquireGroup()
+{
+    if( !m_FreeGroups.IsEmpty() )
+    {
+        return m_FreeGroups.Pop( false );
+    }
+
+    m_Words.AddZeroed( m_WordsPerRow );
+    return m_NumGroups++;
+}
+
+void FHitRegistry::ReleaseGroup( int32 Group )
+{
+    check( Group >= 0 && Group < m_NumGroups );
+
+    FMemory::Memzero( &m_Words[Group * m_WordsPerRow], m_WordsPerRow * sizeof( uint32 ) );
+    m_FreeGroups.Emplace( Group );
+
+    if( m_FreeGroups.Num() == m_NumGroups )
+    {
+        // Every row is already cleared, only their width changes
+        m_TargetSlots.Reset();
+        m_Words.SetNum( m_NumGroups, false );
+        m_WordsPerRow = 1;
+    }
+}
+
+int32 FHitRegistry::FindOrAddTarget( const AActor* Target )
+{
+    ensureMsgf( Target, TEXT("Target is null") );
+
+    const TObjectKey<AActor> targetKey( Target );
+    if( const int32* slot = m_TargetSlots.Find( targetKey ) )
+    {
+        return *slot;
+    }
+
+    const int32 slot = m_TargetSlots.Num();
+    if( slot >= m_WordsPerRow * s_BitsPerWord )
+    {
+        SetWordsPerRow( m_WordsPerRow + 1 );
+    }
+
+    m_TargetSlots.Emplace( targetKey, slot );
+    return slot;
+}
+
+void FHitRegistry::SetWordsPerRow( int32 WordsPerRow )
+{
+    // Rows are moved from the last one so they never overwrite a row that hasn't been moved yet
+    m_Words.AddZeroed( m_NumGroups * (WordsPerRow - m_WordsPerRow) );
+
+    for( int32 group = m_NumGroups - 1; group >= 0; --group )
+    {
+        uint32* from = &m_Words[group * m_WordsPerRow];
+        uint32* to   = &m_Words[group * WordsPerRow];
+
+        FMemory::Memmove( to, from, m_WordsPerRow * sizeof( uint32 ) );
+        FMemory::Memzero( to + m_WordsPerRow, (WordsPerRow - m_WordsPerRow) * sizeof( uint32 ) );
+    }
+
+    m_WordsPerRow = WordsPerRow;
+}
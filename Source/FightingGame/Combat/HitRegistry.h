@@ -0,0 +1,65 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/*
+ * Which hit groups already hit which targets, one bit per (group, target) pair.
+ * Groups and targets get dense slots, the bits of a group are a row of words cleared in one step when the group ends.
+ */
+class FIGHTINGGAME_API FHitRegistry
+{
+public:
+    /*
+     * Slot of a new group, nothing is registered for it yet
+     */
+    int32 AcquireGroup();
+
+    /*
+     * Once no group is in use anymore the targets are forgotten and the rows shrink back to one word
+     */
+    void ReleaseGroup( int32 Group );
+
+    /*
+     * Targets keep their slot while any group is in use
+     */
+    int32 FindOrAddTarget( const AActor* Target );
+
+    FORCEINLINE bool WasHit( int32 Group, int32 Target ) const
+    {
+        return (m_Words[GetWordIdx( Group, Target )] & GetBitMask( Target )) != 0;
+    }
+
+    /*
+     * False if the group already hit the target
+     */
+    FORCEINLINE bool TryRegisterHit( int32 Group, int32 Target )
+    {
+        uint32& word      = m_Words[GetWordIdx( Group, Target )];
+        const uint32 mask = GetBitMask( Target );
+        const bool wasHit = (word & mask) != 0;
+
+        word |= mask;
+
+        return !wasHit;
+    }
+
+private:
+    static constexpr int32 s_BitsPerWord = 32;
+
+    // One row of m_WordsPerRow words per group slot
+    TArray<uint32, TInlineAllocator<8>> m_Words;
+    int32 m_WordsPerRow = 1;
+    int32 m_NumGroups   = 0;
+
+    TArray<int32, TInlineAllocator<8>> m_FreeGroups;
+
+    TMap<TObjectKey<AActor>, int32> m_TargetSlots;
+
+    FORCEINLINE int32 GetWordIdx( int32 Group, int32 Target ) const { return Group * m_WordsPerRow + Target / s_BitsPerWord; }
+    FORCEINLINE static uint32 GetBitMask( int32 Target ) { return 1u << (Target % s_BitsPerWord); }
+
+    void SetWordsPerRow( int32 WordsPerRow );
+};
@@ -0,0 +1,196 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HitResolver.h"
+
+#include "HitboxHandlerComponent.h"
+#include "FightingGame/Collision/CombatCollision.h"
+
+void FHitResolver::Reset()
+{
+    m_Groups.Reset();
+    m_Hitboxes.Reset();
+    m_Candidates.Reset();
+    m_Clashes.Reset();
+    m_SortedCandidates.Reset();
+}
+
+int32 FHitResolver::AddHitbox( UHitboxHandlerComponent* Handler, FHitboxHandle Handle, int32 HitRegistryGroup, const HitData& Hit, const FVector& SweepStart,
+                              const FVector& Location )
+{
+    // Registry rows are unique per handler, the hitboxes of a group can come in any order
+    int32 groupIdx = m_Groups.IndexOfByPredicate( [Handler, HitRegistryGroup]( const FGroup& _group )
+    {
+        return _group.m_Handler == Handler && _group.m_HitRegistryGroup == HitRegistryGroup;
+    } );
+
+    if( groupIdx == INDEX_NONE )
+    {
+        groupIdx = m_Groups.Emplace( FGroup{Handler, Hit.m_Owner, HitRegistryGroup} );
+    }
+
+    return m_Hitboxes.Emplace( FHitbox{groupIdx, Handle, Hit, SweepStart, Location} );
+}
+
+void FHitResolver::AddCandidate( int32 HitboxIdx, const FHitResult& Hit )
+{
+    if( AActor* target = Hit.GetActor() )
+    {
+        m_Candidates.Emplace( FCandidate{HitboxIdx, target->GetUniqueID(), Hit, false} );
+    }
+}
+
+void FHitResolver::ResolveAndApply()
+{
+    if( m_Candidates.IsEmpty() )
+    {
+        return;
+    }
+
+    DetectClashes();
+    DiscardClashedCandidates();
+    SelectBestCandidates();
+
+    // Candidates were gathered in hitbox order, which is stable from one run to the next
+    for( const FCandidate& candidate : m_Candidates )
+    {
+        if( candidate.m_Discarded )
+        {
+            continue;
+        }
+
+        const FHitbox& hitbox = m_Hitboxes[candidate.m_HitboxIdx];
+        const FGroup& group   = m_Groups[hitbox.m_GroupIdx];
+
+        // A previous hit can have destroyed the attacker
+        if( IsValid( group.m_Handler ) )
+        {
+            group.m_Handler->ApplyResolvedHit( hitbox.m_Handle, group.m_HitRegistryGroup, hitbox.m_Hit, candidate.m_HitResult );
+        }
+    }
+}
+
+void FHitResolver::DetectClashes()
+{
+    for( int32 i = 0; i < m_Hitboxes.Num(); ++i )
+    {
+        const FHitbox& hitboxA = m_Hitboxes[i];
+        const FGroup& groupA   = m_Groups[hitboxA.m_GroupIdx];
+
+        for( int32 j = i + 1; j < m_Hitboxes.Num(); ++j )
+        {
+            const FHitbox& hitboxB = m_Hitboxes[j];
+            const FGroup& groupB   = m_Groups[hitboxB.m_GroupIdx];
+
+            const float reach = hitboxA.m_Hit.m_Radius + hitboxB.m_Hit.m_Radius;
+            if( groupA.m_Owner == groupB.m_Owner
+                || FVector2D::DistSquared( ToCombatPlane( hitboxA.m_Location ), ToCombatPlane( hitboxB.m_Location ) ) > reach * reach )
+            {
+                continue;
+            }
+
+            // Clashes are keyed with the lowest group index first
+            const FHitbox* first  = &hitboxA;
+            const FHitbox* second = &hitboxB;
+            if( first->m_GroupIdx > second->m_GroupIdx )
+            {
+                Swap( first, second );
+            }
+
+            FClash* clash = m_Clashes.FindByPredicate( [first, second]( const FClash& _clash )
+            {
+                return _clash.m_GroupIdxA == first->m_GroupIdx && _clash.m_GroupIdxB == second->m_GroupIdx;
+            } );
+
+            if( clash )
+            {
+                clash->m_PriorityA = FMath::Min( clash->m_PriorityA, first->m_Hit.m_Priority );
+                clash->m_PriorityB = FMath::Min( clash->m_PriorityB, second->m_Hit.m_Priority );
+            }
+            else
+            {
+                m_Clashes.Emplace( FClash{first->m_GroupIdx, second->m_GroupIdx, first->m_Hit.m_Priority, second->m_Hit.m_Priority} );
+            }
+        }
+    }
+}
+
+void FHitResolver::DiscardClashedCandidates()
+{
+    // The group with the lowest priority value goes through, on a tie neither hits the other
+    for( const FClash& clash : m_Clashes )
+    {
+        if( clash.m_PriorityA >= clash.m_PriorityB )
+        {
+            DiscardCandidates( clash.m_GroupIdxA, m_Groups[clash.m_GroupIdxB].m_Owner );
+        }
+
+        if( clash.m_PriorityB >= clash.m_PriorityA )
+        {
+            DiscardCandidates( clash.m_GroupIdxB, m_Groups[clash.m_GroupIdxA].m_Owner );
+        }
+    }
+}
+
+void FHitResolver::DiscardCandidates( int32 GroupIdx, const AActor* Target )
+{
+    for( FCandidate& candidate : m_Candidates )
+    {
+        if( m_Hitboxes[candidate.m_HitboxIdx].m_GroupIdx == GroupIdx && candidate.m_HitResult.GetActor() == Target )
+        {
+            candidate.m_Discarded = true;
+        }
+    }
+}
+
+void FHitResolver::SelectBestCandidates()
+{
+    for( int32 candidateIdx = 0; candidateIdx < m_Candidates.Num(); ++candidateIdx )
+    {
+        if( !m_Candidates[candidateIdx].m_Discarded )
+        {
+            m_SortedCandidates.Emplace( candidateIdx );
+        }
+    }
+
+    // Grouped by (hit group, target), best hitbox first then earliest contact, ties go to the first gathered
+    m_SortedCandidates.Sort( [this]( int32 A, int32 B )
+    {
+        const FCandidate& candidateA = m_Candidates[A];
+        const FCandidate& candidateB = m_Candidates[B];
+        const FHitbox& hitboxA       = m_Hitboxes[candidateA.m_HitboxIdx];
+        const FHitbox& hitboxB       = m_Hitboxes[candidateB.m_HitboxIdx];
+
+        if( hitboxA.m_GroupIdx != hitboxB.m_GroupIdx )
+        {
+            return hitboxA.m_GroupIdx < hitboxB.m_GroupIdx;
+        }
+
+        if( candidateA.m_TargetId != candidateB.m_TargetId )
+        {
+            return candidateA.m_TargetId < candidateB.m_TargetId;
+        }
+
+        if( hitboxA.m_Hit.m_Priority != hitboxB.m_Hit.m_Priority )
+        {
+            return hitboxA.m_Hit.m_Priority < hitboxB.m_Hit.m_Priority;
+        }
+
+        if( candidateA.m_HitResult.Time != candidateB.m_HitResult.Time )
+        {
+            return candidateA.m_HitResult.Time < candidateB.m_HitResult.Time;
+        }
+
+        return A < B;
+    } );
+
+    for( int32 i = 1; i < m_SortedCandidates.Num(); ++i )
+    {
+        const FCandidate& previous = m_Candidates[m_SortedCandidates[i - 1]];
+        FCandidate& candidate      = m_Candidates[m_SortedCandidates[i]];
+
+        if( m_Hitboxes[previous.m_HitboxIdx].m_GroupIdx == m_Hitboxes[candidate.m_HitboxIdx].m_GroupIdx && previous.m_TargetId == candidate.m_TargetId )
+        {
+            candidate.m_Discarded = true;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "FightingGame/Combat/HitData.h"
+#include "FightingGame/Combat/HitboxStore.h"
+
+class UHitboxHandlerComponent;
+
+/*
+ * Resolves the hits of a frame in two phases, so the outcome doesn't depend on which hitbox is tested first.
+ * Every active hitbox and every target it touches are gathered first. Then only one hitbox per (hit group, target) pair hits, the one with the
+ * lowest priority value, hitboxes of different owners touching each other clash, and the remaining hits are applied in gather order.
+ * Between swept hitboxes of the same priority, the one that touched the target first hits.
+ * Two characters hitting each other on the same frame both get hit (trade), even when the first hit applied ends the other move.
+ */
+class FIGHTINGGAME_API FHitResolver
+{
+public:
+    void Reset();
+
+    /*
+     * Location is where the hitbox is this frame, SweepStart where its trace starts (Location too when it isn't swept)
+     */
+    int32 AddHitbox( UHitboxHandlerComponent* Handler, FHitboxHandle Handle, int32 HitRegistryGroup, const HitData& Hit, const FVector& SweepStart,
+                     const FVector& Location );
+    void AddCandidate( int32 HitboxIdx, const FHitResult& Hit );
+
+    FORCEINLINE int32 GetNumHitboxes() const { return m_Hitboxes.Num(); }
+    FORCEINLINE const FVector& GetHitboxSweepStart( int32 HitboxIdx ) const { return m_Hitboxes[HitboxIdx].m_SweepStart; }
+    FORCEINLINE const FVector& GetHitboxLocation( int32 HitboxIdx ) const { return m_Hitboxes[HitboxIdx].m_Location; }
+
+    void ResolveAndApply();
+
+private:
+    struct FGroup
+    {
+        UHitboxHandlerComponent* m_Handler = nullptr;
+        const AActor* m_Owner              = nullptr;
+        int32 m_HitRegistryGroup           = INDEX_NONE;
+    };
+
+    // Gathered by copy, applying a hit can remove the hitboxes of the next ones
+    struct FHitbox
+    {
+        int32 m_GroupIdx;
+        FHitboxHandle m_Handle;
+        HitData m_Hit;
+        FVector m_SweepStart;
+        FVector m_Location;
+    };
+
+    struct FCandidate
+    {
+        int32 m_HitboxIdx;
+        uint32 m_TargetId;
+        FHitResult m_HitResult;
+        bool m_Discarded;
+    };
+
+    /*
+     * Lowest priority value of the touching hitboxes on each side
+     */
+    struct FClash
+    {
+        int32 m_GroupIdxA;
+        int32 m_GroupIdxB;
+        int32 m_PriorityA;
+        int32 m_PriorityB;
+    };
+
+    TArray<FGroup> m_Groups;
+    TArray<FHitbox> m_Hitboxes;
+    TArray<FCandidate> m_Candidates;
+    TArray<FClash> m_Clashes;
+    TArray<int32> m_SortedCandidates;
+
+    void DetectClashes();
+    void DiscardClashedCandidates();
+    void DiscardCandidates( int32 GroupIdx, const AActor* Target );
+    void SelectBestCandidates();
+};
@@ -1,18 +1,19 @@
 // Copyright (c) Giammarco Agazzotti
 
 #include "HitboxHandlerComponent.h"
+#include "CombatManager.h"
 #include "Hittable.h"
+#include "MoveDataAsset.h"
+#include "Animation/AnimInstance.h"
 #include "FightingGame/Collision/CustomCollisionChannels.h"
 #include "FightingGame/Common/CombatStatics.h"
-#include "FightingGame/Debugging/Debug.h"
-#include "FightingGame/Debugging/HitboxVisualizer.h"
-#include "FightingGame/Debugging/SphereVisualizer.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "FightingGame/Common/GameFramework.h"
+#include "FightingGame/Debugging/HitboxAllocationCounter.h"
+#include "FightingGame/Debugging/HitboxDebugRenderer.h"
 
 namespace
 {
-    int32 loc_ShowHitboxTraces = 0;
-    FG_CVAR_FLAG_DESC( CVarShowHitboxTraces, TEXT( "HitboxHandlerComponent.ShowHitboxTraces" ), loc_ShowHitboxTraces );
+    const FCollisionObjectQueryParams loc_HurtboxObjectQueryParams( CUSTOM_TRACE_HURTBOX );
 }
 
 UHitboxHandlerComponent::UHitboxHandlerComponent()
@@ -24,6 +25,9 @@ void UHitboxHandlerComponent::BeginPlay()
 {
     Super::BeginPlay();
 
+    // Without a combat manager the handler resolves its own hitboxes with physics traces
+    SetCombatManager( AGameFramework::FindWorldManager<ACombatManager>( GetWorld() ) );
+
     if( m_SpawnDefaultHitboxesOnBeginPlay )
     {
         SpawnDefaultHitboxes();
@@ -34,72 +38,111 @@ void UHitboxHandlerComponent::EndPlay( const EEndPlayReason::Type EndPlayReason
 {
     Super::EndPlay( EndPlayReason );
 
-    for( const auto& tuple : m_ActiveGroupedHitboxes )
-    {
-        for( const auto& hit : tuple.Value )
-        {
-            DEBUG_DestroyDebugSphere( hit.m_Id );
-        }
-    }
+    SetCombatManager( nullptr );
 }
 
 void UHitboxHandlerComponent::SetReferenceComponent( TObjectPtr<USceneComponent> Component )
 {
+    if( m_ReferenceComponent )
+    {
+        RemoveTickPrerequisiteComponent( m_ReferenceComponent );
+    }
+
     m_ReferenceComponent = Component;
+
+    if( m_ReferenceComponent )
+    {
+        AddTickPrerequisiteComponent( m_ReferenceComponent );
+    }
 }
 
-void UHitboxHandlerComponent::AddHitbox( HitData Hit )
+void UHitboxHandlerComponent::SetCombatManager( ACombatManager* CombatManager )
 {
-    if( m_ActiveGroupedHitboxes.Contains( Hit.m_GroupId ) )
+    if( m_CombatManager )
     {
-        m_ActiveGroupedHitboxes[Hit.m_GroupId].AddUnique( Hit );
+        m_CombatManager->UnregisterHitboxHandler( this );
+    }
 
-        // #TODO temp, this is expensive
-        m_ActiveGroupedHitboxes[Hit.m_GroupId].Sort( []( const HitData& A, const HitData& B )
-        {
-            return A.m_Priority < B.m_Priority;
-        } );
+    m_CombatManager = CombatManager;
+
+    if( m_CombatManager )
+    {
+        m_CombatManager->RegisterHitboxHandler( this );
+    }
+}
+
+FHitboxHandle UHitboxHandlerComponent::AddHitbox( const HitData& Hit )
+{
+    FG_HITBOX_ALLOCATION_SCOPE();
+
+    FHitboxGroup& group = m_HitboxGroups.FindOrAdd( Hit.m_GroupId );
+    if( group.m_NumHitboxes++ == 0 )
+    {
+        group.m_HitRegistryGroup = m_HitRegistry.AcquireGroup();
     }
-    else
+
+    // Priorities are handled when the hits of the frame are resolved, the hitboxes don't need to be sorted
+    const FHitboxHandle handle = m_Hitboxes.Add( Hit, group.m_HitRegistryGroup );
+    FActiveHitbox& hitbox      = *m_Hitboxes.Find( handle );
+
+    hitbox.m_Hit.m_ActorsToIgnore = GetIgnoreList( Hit.m_Owner );
+
+    if( Hit.m_SkeletalMesh && !Hit.m_SocketToFollow.IsNone() && !Hit.m_BakedTrack )
     {
-        m_ActiveGroupedHitboxes.Add( Hit.m_GroupId, {Hit} );
+        hitbox.m_SocketIdx = m_SocketTransforms.AddSocket( Hit.m_SkeletalMesh, Hit.m_SocketToFollow );
     }
 
-    if( loc_ShowHitboxTraces && m_HitboxVisualizer )
+    return handle;
+}
+
+void UHitboxHandlerComponent::RemoveHitbox( FHitboxHandle Handle )
+{
+    FActiveHitbox* hitbox = m_Hitboxes.Find( Handle );
+    if( hitbox && !hitbox->m_Hit.m_PendingRemoval )
     {
-        DEBUG_SpawnDebugSphere( Hit );
+        hitbox->m_Hit.m_PendingRemoval = true;
+        m_PendingRemovals.Emplace( Handle );
     }
 }
 
-void UHitboxHandlerComponent::RemoveHitbox( uint32 HitUniqueId )
+void UHitboxHandlerComponent::RemoveHitboxGroup( int32 GroupId )
 {
-    for( auto& tuple : m_ActiveGroupedHitboxes )
+    if( !m_HitboxGroups.Contains( GroupId ) )
     {
-        auto* it = tuple.Value.FindByPredicate( [&HitUniqueId]( const HitData& HitData )
-        {
-            return HitData.m_Id == HitUniqueId;
-        } );
+        return;
+    }
 
-        if( it )
+    ForEachActiveHitbox( [this, GroupId]( FHitboxHandle _handle, FActiveHitbox& _hitbox )
+    {
+        if( _hitbox.m_Hit.m_GroupId == GroupId )
         {
-            it->m_PendingRemoval = true;
+            RemoveHitbox( _handle );
         }
-    }
+    } );
 }
 
 void UHitboxHandlerComponent::UpdateHitboxes()
 {
-    for( const auto& tuple : m_ActiveGroupedHitboxes )
+    m_HitResolver.Reset();
+
+    RefreshSocketTransforms();
+
+    // Hitboxes are only swept by the combat manager
+    ForEachActiveHitbox( [this]( FHitboxHandle _handle, FActiveHitbox& _hitbox )
     {
-        for( int hitIdx = 0; hitIdx < tuple.Value.Num(); ++hitIdx )
+        const FVector location = GetHitTraceLocation( _hitbox );
+        const int32 hitboxIdx  = m_HitResolver.AddHitbox( this, _handle, _hitbox.m_HitRegistryGroup, _hitbox.m_Hit, location, location );
+
+        FHitResult outHit;
+        if( TraceHitbox( _hitbox.m_Hit, location, location, outHit ) )
         {
-            const auto& hit = tuple.Value[hitIdx];
-            if( !hit.m_PendingRemoval )
-            {
-                UpdateHitbox( hit );
-            }
+            m_HitResolver.AddCandidate( hitboxIdx, outHit );
         }
-    }
+    } );
+
+    m_HitResolver.ResolveAndApply();
+
+    DEBUG_DrawHitboxes();
 }
 
 void UHitboxHandlerComponent::ShowDebugTraces( bool Show )
@@ -109,10 +152,18 @@ void UHitboxHandlerComponent::ShowDebugTraces( bool Show )
 
 void UHitboxHandlerComponent::SpawnDefaultHitboxes()
 {
+    // Spawning them again replaces them, e.g. once a projectile knows which actors to ignore
+    for( FHitboxHandle handle : m_DefaultHitboxHandles )
+    {
+        RemoveHitbox( handle );
+    }
+
+    m_DefaultHitboxHandles.Reset();
+
     for( int i = 0; i < m_DefaultHitboxes.Num(); ++i )
     {
-        AddHitbox( UCombatStatics::GenerateHitDataFromHitboxDescription( GetOwner(), nullptr, m_DefaultHitboxes[i],
-                                                                         i, GetOwner()->GetUniqueID(), m_AdditionalActorsToIgnore ) );
+        m_DefaultHitboxHandles.Emplace(
+            AddHitbox( UCombatStatics::GenerateHitDataFromHitboxDescription( GetOwner(), nullptr, m_DefaultHitboxes[i], i, GetOwner()->GetUniqueID() ) ) );
     }
 }
 
@@ -120,78 +171,43 @@ void UHitboxHandlerComponent::TickComponent( float DeltaTime, ELevelTick TickTyp
 {
     Super::TickComponent( DeltaTime, TickType, ThisTickFunction );
 
-    UpdateHitboxes();
+    FG_HITBOX_ALLOCATION_SCOPE();
 
-    DEBUG_UpdateDebugSpheres();
+    // Resolved by the combat manager batch otherwise
+    if( !m_CombatManager )
+    {
+        UpdateHitboxes();
+    }
 
     RemovePendingHitboxes();
 }
 
-bool UHitboxHandlerComponent::TraceHitbox( const HitData& HitData, FHitResult& OutHit )
+bool UHitboxHandlerComponent::TraceHitbox( const HitData& HitData, const FVector& Start, const FVector& End, FHitResult& OutHit )
 {
-    TArray<TEnumAsByte<EObjectTypeQuery>> targetTraceTypes;
-
-    const EObjectTypeQuery targetCollisionType = UEngineTypes::ConvertToObjectType( CUSTOM_TRACE_HURTBOX );
-    targetTraceTypes.Add( targetCollisionType );
-
-    FVector location = GetHitTraceLocation( HitData );
-
-    TArray<TObjectPtr<AActor>> actorsToIgnore;
-    HitData.GetActorsToIgnore( actorsToIgnore );
-
-    bool didHit = UKismetSystemLibrary::SphereTraceSingleForObjects( HitData.m_World, location, location, HitData.m_Radius, targetTraceTypes,
-                                                                     false, actorsToIgnore, EDrawDebugTrace::None, OutHit, true );
-
-    return didHit;
+    // Same sweep as SphereTraceSingleForObjects, without rebuilding the object types and the ignored actors every call
+    return HitData.m_World->SweepSingleByObjectType( OutHit, Start, End, FQuat::Identity, loc_HurtboxObjectQueryParams,
+                                                     FCollisionShape::MakeSphere( HitData.m_Radius ), HitData.m_ActorsToIgnore->GetQueryParams() );
 }
 
-bool UHitboxHandlerComponent::WasActorAlreadyHit( AActor* Actor, const HitData& Hit )
+void UHitboxHandlerComponent::ApplyResolvedHit( FHitboxHandle Handle, int32 HitRegistryGroup, const HitData& HitData, const FHitResult& Hit )
 {
-    ensureMsgf( Actor, TEXT("Actor is null") );
-
-    if( !m_ActorGroupsMap.Find( Actor->GetUniqueID() ) ) return false;
-
-    return m_ActorGroupsMap[Actor->GetUniqueID()].ContainsByPredicate( [&]( const FHitGroupPair _pair )
-    {
-        return _pair.m_GroupId == Hit.m_GroupId;
-    } );
-}
-
-void UHitboxHandlerComponent::RegisterHitActor( AActor* Actor, const HitData& Hit )
-{
-    ensureMsgf( Actor, TEXT("Actor is null") );
-
-    if( m_ActorGroupsMap.Contains( Actor->GetUniqueID() ) )
-    {
-        m_ActorGroupsMap[Actor->GetUniqueID()].AddUnique( FHitGroupPair{Hit.m_Id, Hit.m_GroupId} );
-    }
-    else
-    {
-        TArray groupsArray = {FHitGroupPair{Hit.m_Id, Hit.m_GroupId}};
-        m_ActorGroupsMap.Emplace( Actor->GetUniqueID(), groupsArray );
-    }
-}
-
-void UHitboxHandlerComponent::UpdateHitbox( const HitData& HitData )
-{
-    FHitResult outHit;
-    const bool success = TraceHitbox( HitData, outHit );
-
-    AActor* hitActor = outHit.GetActor();
+    AActor* hitActor = Hit.GetActor();
     if( auto* hittable = Cast<IHittable>( hitActor ) )
     {
         if( hittable->IsHittable() )
         {
-            if( success && !WasActorAlreadyHit( hitActor, HitData ) )
+            if( m_HitRegistry.TryRegisterHit( HitRegistryGroup, m_HitRegistry.FindOrAddTarget( hitActor ) ) )
             {
-                RegisterHitActor( hitActor, HitData );
+                FG_HITBOX_ALLOCATION_EXCLUDE();
 
                 hittable->OnHitReceived( HitData );
                 m_HitDelegate.Broadcast( hitActor, HitData );
 
-                if( TObjectPtr<AHitboxVisualizer> visualizer = DEBUG_GetHitboxVisualizerOrDefault( HitData.m_Id ) )
+                // Still there unless the handler ticked since the hit was found
+                FActiveHitbox* hitbox = m_Hitboxes.Find( Handle );
+                if( hitbox )
                 {
-                    visualizer->SetHitState();
+                    hitbox->m_HasHit = true;
                 }
             }
         }
@@ -200,119 +216,93 @@ void UHitboxHandlerComponent::UpdateHitbox( const HitData& HitData )
 
 void UHitboxHandlerComponent::RemovePendingHitboxes()
 {
-    for( auto& tuple : m_ActiveGroupedHitboxes )
+    for( FHitboxHandle handle : m_PendingRemovals )
     {
-        for( int i = tuple.Value.Num() - 1; i >= 0; --i )
+        FActiveHitbox* hitbox = m_Hitboxes.Find( handle );
+        if( !hitbox )
         {
-            if( tuple.Value[i].m_PendingRemoval )
-            {
-                TArray<uint32> targetKeys;
-                for( const auto& pair : m_ActorGroupsMap )
-                {
-                    if( pair.Value.ContainsByPredicate( [&]( const FHitGroupPair& hitPair )
-                    {
-                        return hitPair.m_Id == tuple.Value[i].m_Id;
-                    } ) )
-                    {
-                        targetKeys.Emplace( pair.Key );
-                    }
-                }
-
-                for( int keyIdx = 0; keyIdx < targetKeys.Num(); ++keyIdx )
-                {
-                    uint32 targetKey = targetKeys[keyIdx];
-
-                    for( int j = m_ActorGroupsMap[targetKey].Num() - 1; j >= 0; --j )
-                    {
-                        if( m_ActorGroupsMap[targetKey][j].m_Id == tuple.Value[i].m_Id )
-                        {
-                            m_ActorGroupsMap[targetKey].RemoveAt( j );
-                        }
-                    }
-                }
+            continue;
+        }
 
-                DEBUG_DestroyDebugSphere( tuple.Value[i].m_Id );
+        if( hitbox->m_SocketIdx != INDEX_NONE )
+        {
+            m_SocketTransforms.RemoveSocket( hitbox->m_SocketIdx );
+        }
 
-                tuple.Value.RemoveAt( i );
-            }
+        // The group ended, its targets can be hit again the next time it spawns
+        const int32 groupId = hitbox->m_Hit.m_GroupId;
+        FHitboxGroup& group = m_HitboxGroups.FindChecked( groupId );
+        if( --group.m_NumHitboxes == 0 )
+        {
+            m_HitRegistry.ReleaseGroup( group.m_HitRegistryGroup );
+            m_HitboxGroups.Remove( groupId );
         }
+
+        m_Hitboxes.Remove( handle );
     }
+
+    m_PendingRemovals.Reset();
 }
 
-FVector UHitboxHandlerComponent::GetHitTraceLocation( const HitData& Hit )
+const TSharedPtr<const FHitboxIgnoreList>& UHitboxHandlerComponent::GetIgnoreList( const AActor* HitboxOwner )
 {
-    bool hasSocketToFollow = Hit.m_SkeletalMesh ? (!Hit.m_SocketToFollow.ToString().IsEmpty()) : false;
-
-    if( hasSocketToFollow )
+    // Rebuilt only when the ignored actors change, the hitboxes added in between share it
+    if( !m_IgnoreList || !m_IgnoreList->Matches( HitboxOwner, m_AdditionalActorsToIgnore ) )
     {
-        FVector socketLocation = Hit.m_SkeletalMesh->GetSocketLocation( Hit.m_SocketToFollow );
-        socketLocation.X       = Hit.m_Owner->GetActorLocation().X;
-
-        return socketLocation;
+        m_IgnoreList = MakeShared<const FHitboxIgnoreList>( HitboxOwner, m_AdditionalActorsToIgnore );
     }
 
-    return Hit.m_Owner->GetActorLocation() + Hit.m_Location;
+    return m_IgnoreList;
 }
 
-void UHitboxHandlerComponent::DEBUG_SpawnDebugSphere( const HitData& Hit )
+void UHitboxHandlerComponent::RefreshSocketTransforms()
 {
-    if( !m_HitboxVisualizer )
-    {
-        FG_SLOG_WARN( TEXT("HitboxVisualizer is null, hiboxes will not be shown for this object") );
-        return;
-    }
-
-    TObjectPtr<AHitboxVisualizer> inst = Hit.m_World->SpawnActor<AHitboxVisualizer>( m_HitboxVisualizer );
+    m_SocketTransforms.Refresh();
+}
 
-    inst->SetId( Hit.m_Id );
-    inst->SetRadius( Hit.m_Radius );
-    inst->SetVisualizerOwner( Hit.m_Owner );
-    inst->SetKnockback( Hit.m_ProcessedKnockback );
+FVector UHitboxHandlerComponent::GetHitTraceLocation( const FActiveHitbox& Hitbox ) const
+{
+    const HitData& hit = Hitbox.m_Hit;
 
-    if( Hit.m_SkeletalMesh )
+    // The pose is not needed, only where the montage is
+    if( hit.m_BakedTrack )
     {
-        if( m_ReferenceComponent )
-        {
-            inst->AttachToComponent( m_ReferenceComponent, FAttachmentTransformRules::SnapToTargetNotIncludingScale, Hit.m_SocketToFollow );
-        }
-    }
-    else
-    {
-        inst->SetLocation( Hit.m_Location );
-    }
+        const UAnimInstance* animInstance = hit.m_SkeletalMesh->GetAnimInstance();
+        const float montagePosition       = animInstance ? animInstance->Montage_GetPosition( hit.m_BakedMontage ) : hit.m_BakedTrack->m_StartTime;
 
-    m_HitboxVisualizers.Emplace( inst );
-}
+        FVector trackLocation = hit.m_SkeletalMesh->GetComponentTransform().TransformPosition( hit.m_BakedTrack->Sample( montagePosition ) );
+        trackLocation.X       = hit.m_Owner->GetActorLocation().X;
 
-TObjectPtr<AHitboxVisualizer> UHitboxHandlerComponent::DEBUG_GetHitboxVisualizerOrDefault( int HitboxId )
-{
-    auto* it = m_HitboxVisualizers.FindByPredicate( [&HitboxId]( TObjectPtr<AHitboxVisualizer> _vis )
+        return trackLocation;
+    }
+
+    if( Hitbox.m_SocketIdx != INDEX_NONE )
     {
-        return _vis->GetId() == HitboxId;
-    } );
+        FVector socketLocation = m_SocketTransforms.GetSocketTransform( Hitbox.m_SocketIdx ).GetLocation();
+        socketLocation.X       = hit.m_Owner->GetActorLocation().X;
 
-    return it ? *it : nullptr;
+        return socketLocation;
+    }
+
+    return hit.m_Owner->GetActorLocation() + hit.m_Location;
 }
 
-void UHitboxHandlerComponent::DEBUG_DestroyDebugSphere( int HitboxId )
+void UHitboxHandlerComponent::DEBUG_DrawHitboxes()
 {
-    for( int visIdx = m_HitboxVisualizers.Num() - 1; visIdx >= 0; --visIdx )
+#if FG_HITBOX_DEBUG_RENDERER
+    FHitboxDebugRenderer* renderer = m_DebugTraces ? FHitboxDebugRenderer::Get( GetWorld() ) : nullptr;
+    if( !renderer )
     {
-        if( HitboxId == m_HitboxVisualizers[visIdx]->GetId() )
-        {
-            GetWorld()->DestroyActor( m_HitboxVisualizers[visIdx] );
-            m_HitboxVisualizers.RemoveAt( visIdx );
-        }
+        return;
     }
-}
 
-void UHitboxHandlerComponent::DEBUG_UpdateDebugSpheres()
-{
-    for( TObjectPtr<ASphereVisualizer> visualizer : m_HitboxVisualizers )
+    // Drawn where they were tested, after the hits of the frame are resolved
+    ForEachActiveHitbox( [this, renderer]( FHitboxHandle /*_handle*/, const FActiveHitbox& _hitbox )
     {
-        if( visualizer->GetLocation().IsSet() && visualizer->GetVisualizerOwner() )
+        if( _hitbox.m_Hit.m_Owner )
         {
-            visualizer->SetActorLocation( visualizer->GetVisualizerOwner()->GetActorLocation() + visualizer->GetLocation().GetValue() );
+            renderer->AddHitbox( GetHitTraceLocation( _hitbox ), _hitbox.m_Hit.m_Radius, _hitbox.m_Hit.m_ProcessedKnockback, _hitbox.m_HasHit );
         }
-    }
+    } );
+#endif
 }
@@ -6,27 +6,23 @@
 #include "HitboxDescription.h"
 #include "Components/ActorComponent.h"
 #include "FightingGame/Combat/HitData.h"
+#include "FightingGame/Combat/HitRegistry.h"
+#include "FightingGame/Combat/HitResolver.h"
+#include "FightingGame/Combat/HitboxStore.h"
+#include "FightingGame/Combat/SocketTransformCache.h"
 #include "HitboxHandlerComponent.generated.h"
 
-class AHitboxVisualizer;
+class ACombatManager;
 struct FHitboxDescription;
 
 DECLARE_MULTICAST_DELEGATE_TwoParams( FHit, TObjectPtr<AActor>, const HitData& )
 
-struct FHitGroupPair
+struct FHitboxGroup
 {
-	uint32 m_Id   = -1;
-	int m_GroupId = -1;
+	int32 m_NumHitboxes = 0;
 
-	friend bool operator==( const FHitGroupPair& Lhs, const FHitGroupPair& Rhs )
-	{
-		return Lhs.m_Id == Rhs.m_Id && Lhs.m_GroupId == Rhs.m_GroupId;
-	}
-
-	friend bool operator!=( const FHitGroupPair& Lhs, const FHitGroupPair& Rhs )
-	{
-		return !(Lhs == Rhs);
-	}
+	// Row of the group in the hit registry, held while the group has hitboxes
+	int32 m_HitRegistryGroup = INDEX_NONE;
 };
 
 UCLASS( ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
@@ -38,9 +34,6 @@ public:
 	UHitboxHandlerComponent();
 
 protected:
-	UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Hitbox Visualizer" )
-	TSubclassOf<AHitboxVisualizer> m_HitboxVisualizer = nullptr;
-
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Default Hitboxes" )
 	TArray<FHitboxDescription> m_DefaultHitboxes;
 
@@ -57,37 +50,101 @@ public:
 	FHit m_HitDelegate;
 	TArray<TObjectPtr<AActor>> m_AdditionalActorsToIgnore;
 
+	/*
+	 * The handler ticks after the reference component, so it reads the pose evaluated this frame
+	 */
 	void SetReferenceComponent( TObjectPtr<USceneComponent> Component );
 
-	void AddHitbox( HitData Hit );
-	void RemoveHitbox( uint32 HitUniqueId );
+	/*
+	 * The manager resolves the hitboxes of the handler in its batch, null lets the handler resolve them itself. Set on BeginPlay
+	 */
+	void SetCombatManager( ACombatManager* CombatManager );
+
+	/*
+	 * The hitbox stays active until removed with the returned handle
+	 */
+	FHitboxHandle AddHitbox( const HitData& Hit );
+
+	/*
+	 * The hitbox stops hitting right away and is freed on the next tick, stale handles are ignored
+	 */
+	void RemoveHitbox( FHitboxHandle Handle );
+
+	/*
+	 * Removes every active hitbox added with this group id, like RemoveHitbox on each of them
+	 */
+	void RemoveHitboxGroup( int32 GroupId );
+
 	void UpdateHitboxes();
 
 	void ShowDebugTraces( bool Show );
 
+	/*
+	 * Queues the active hitboxes in the debug renderer of the world, nothing is drawn while the hitbox traces cvar is off
+	 */
+	void DEBUG_DrawHitboxes();
+
+	template<typename FunctionType>
+	void ForEachActiveHitbox( FunctionType Function );
+
+	/*
+	 * Hitboxes hit their target once per group, the hit is ignored if the group already hit it
+	 */
+	void ApplyResolvedHit( FHitboxHandle Handle, int32 HitRegistryGroup, const HitData& HitData, const FHitResult& Hit );
+
+	/*
+	 * Physics sweep of the hitbox from Start to End, a hitbox that doesn't move only tests End.
+	 * Used without a combat manager and in its physics trace mode, the analytic mode tests its own collision world
+	 */
+	bool TraceHitbox( const HitData& HitData, const FVector& Start, const FVector& End, FHitResult& OutHit );
+
+	/*
+	 * Reads the followed sockets of every active hitbox once, call before GetHitTraceLocation each time the hitboxes are resolved
+	 */
+	void RefreshSocketTransforms();
+
+	FVector GetHitTraceLocation( const FActiveHitbox& Hitbox ) const;
+
 	void SpawnDefaultHitboxes();
 
 	virtual void TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
 
 private:
-	TMap<uint32, TArray<FHitGroupPair>> m_ActorGroupsMap;
-	TMap<int, TArray<HitData>> m_ActiveGroupedHitboxes;
+	FHitRegistry m_HitRegistry;
 
-	TArray<TObjectPtr<AHitboxVisualizer>> m_HitboxVisualizers;
+	// Used when there is no combat manager to resolve the hits
+	FHitResolver m_HitResolver;
 
-	bool m_DebugTraces = true;
+	FHitboxStore m_Hitboxes;
+	TMap<int32, FHitboxGroup> m_HitboxGroups;
+	TArray<FHitboxHandle> m_PendingRemovals;
+	TArray<FHitboxHandle> m_DefaultHitboxHandles;
 
-	bool TraceHitbox( const HitData& HitData, FHitResult& OutHit );
-	bool WasActorAlreadyHit( AActor* Actor, const HitData& Hit );
-	void RegisterHitActor( AActor* Actor, const HitData& Hit );
-	void UpdateHitbox( const HitData& HitData );
+	TSharedPtr<const FHitboxIgnoreList> m_IgnoreList;
 
-	void RemovePendingHitboxes();
+	FSocketTransformCache m_SocketTransforms;
+
+	UPROPERTY()
+	TObjectPtr<ACombatManager> m_CombatManager = nullptr;
 
-	FVector GetHitTraceLocation( const HitData& Hit );
+	bool m_DebugTraces = true;
+
+	const TSharedPtr<const FHitboxIgnoreList>& GetIgnoreList( const AActor* HitboxOwner );
 
-	void DEBUG_SpawnDebugSphere( const HitData& Hit );
-	TObjectPtr<AHitboxVisualizer> DEBUG_GetHitboxVisualizerOrDefault( int HitboxId );
-	void DEBUG_DestroyDebugSphere( int HitboxId );
-	void DEBUG_UpdateDebugSpheres();
+	void RemovePendingHitboxes();
 };
+
+/*
+ * Function( FHitboxHandle, FActiveHitbox& ), the resolver of the hitboxes advances their sweep
+ */
+template<typename FunctionType>
+void UHitboxHandlerComponent::ForEachActiveHitbox( FunctionType Function )
+{
+	m_Hitboxes.ForEach( [&Function]( FHitboxHandle _handle, FActiveHitbox& _hitbox )
+	{
+		if( !_hitbox.m_Hit.m_PendingRemoval )
+		{
+			Function( _handle, _hitbox );
+		}
+	} );
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HitboxIgnoreList.h"
+
+FHitboxIgnoreList::FHitboxIgnoreList( const AActor* Owner, TConstArrayView<TObjectPtr<AActor>> AdditionalActors )
+    : m_QueryParams( SCENE_QUERY_STAT( HitboxTrace ), false )
+{
+    m_Actors.Reserve( AdditionalActors.Num() + 1 );
+    m_Actors.Emplace( Owner );
+
+    for( const TObjectPtr<AActor>& actor : AdditionalActors )
+    {
+        m_Actors.Emplace( actor );
+    }
+
+    // Same params SphereTraceSingleForObjects builds on every call
+    m_QueryParams.bReturnPhysicalMaterial = true;
+    for( const AActor* actor : m_Actors )
+    {
+        m_QueryParams.AddIgnoredActor( actor );
+    }
+}
+
+bool FHitboxIgnoreList::Matches( const AActor* Owner, TConstArrayView<TObjectPtr<AActor>> AdditionalActors ) const
+{
+    if( m_Actors.Num() != AdditionalActors.Num() + 1 || m_Actors[0] != Owner )
+    {
+        return false;
+    }
+
+    for( int32 i = 0; i < AdditionalActors.Num(); ++i )
+    {
+        if( m_Actors[i + 1] != AdditionalActors[i] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
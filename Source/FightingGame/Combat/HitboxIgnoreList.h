@@ -0,0 +1,29 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+
+/*
+ * Actors a hitbox never hits, its owner first. A list is immutable once built and shared by every hitbox spawned with the same actors,
+ * tracing reads it in place instead of copying it into a fresh array.
+ */
+class FIGHTINGGAME_API FHitboxIgnoreList
+{
+public:
+    FHitboxIgnoreList( const AActor* Owner, TConstArrayView<TObjectPtr<AActor>> AdditionalActors );
+
+    bool Matches( const AActor* Owner, TConstArrayView<TObjectPtr<AActor>> AdditionalActors ) const;
+
+    FORCEINLINE TConstArrayView<const AActor*> GetActors() const { return m_Actors; }
+
+    /*
+     * Params of the physics trace fallback, built once with the same ignored actors
+     */
+    FORCEINLINE const FCollisionQueryParams& GetQueryParams() const { return m_QueryParams; }
+
+private:
+    TArray<const AActor*, TInlineAllocator<4>> m_Actors;
+    FCollisionQueryParams m_QueryParams;
+};
@@ -4,7 +4,9 @@
 
 #include "HitboxHandlerComponent.h"
 #include "FightingGame/Character/FightingCharacter.h"
+#include "MoveDataAsset.h"
 #include "FightingGame/Common/CombatStatics.h"
+#include "FightingGame/Debugging/Debug.h"
 
 void UHitboxNotifyState::NotifyBegin( USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration,
                                       const FAnimNotifyEventReference& EventReference )
@@ -13,10 +15,34 @@ void UHitboxNotifyState::NotifyBegin( USkeletalMeshComponent* MeshComp, UAnimSeq
 
 	if( auto* character = Cast<AFightingCharacter>( MeshComp->GetOwner() ) )
 	{
+		// Baked with the move playing this montage, the hitboxes follow their track instead of the animated sockets
+		const UMoveDataAsset* move = character->GetCurrentMove();
+		if( move && move->m_AnimationMontageAsset.Get() != Animation )
+		{
+			move = nullptr;
+		}
+
 		for( int i = 0; i < m_HitBoxes.Num(); ++i )
 		{
-			const HitData& Data = UCombatStatics::GenerateHitDataFromHitboxDescription( character, MeshComp, m_HitBoxes[i], i, GetUniqueID() );
-			character->GetHitboxHandler()->AddHitbox( Data );
+			HitData hit = UCombatStatics::GenerateHitDataFromHitboxDescription( character, MeshComp, m_HitBoxes[i], i, GetUniqueID() );
+
+			if( move && !hit.m_SocketToFollow.IsNone() )
+			{
+				const FBakedHitboxTrack* track = move->FindBakedHitboxTrack( this, i, hit.m_SocketToFollow );
+
+				// Tracks are baked when the move is saved, a window edited in the montage since falls back to the animated socket
+				const FAnimNotifyEvent* notifyEvent = EventReference.GetNotify();
+				if( track && notifyEvent && !track->MatchesWindow( *notifyEvent ) )
+				{
+					FG_SLOG_WARN( FString::Printf( TEXT("Move [%s]: hitbox %d track is stale, save the move to bake it again"), *move->GetName(), i ) );
+					track = nullptr;
+				}
+
+				hit.m_BakedTrack   = track;
+				hit.m_BakedMontage = move->m_AnimationMontageAsset;
+			}
+
+			character->GetHitboxHandler()->AddHitbox( hit );
 		}
 	}
 }
@@ -27,9 +53,6 @@ void UHitboxNotifyState::NotifyEnd( USkeletalMeshComponent* MeshComp, UAnimSeque
 
 	if( auto* character = Cast<AFightingCharacter>( MeshComp->GetOwner() ) )
 	{
-		for( int i = 0; i < m_HitBoxes.Num(); ++i )
-		{
-			character->GetHitboxHandler()->RemoveHitbox( i );
-		}
+		character->GetHitboxHandler()->RemoveHitboxGroup( GetUniqueID() );
 	}
 }
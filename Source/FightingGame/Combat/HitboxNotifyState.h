@@ -20,5 +20,8 @@ public:
 	virtual void NotifyBegin( USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration,
 	                          const FAnimNotifyEventReference& EventReference ) override;
 
+	/*
+	 * The notify is shared by every character playing the montage, the handler of each character removes the hitboxes of its group
+	 */
 	virtual void NotifyEnd( USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference ) override;
 };
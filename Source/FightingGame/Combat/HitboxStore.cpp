@@ -0,0 +1,51 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HitboxStore.h"
+
+FHitboxHandle FHitboxStore::Add( const HitData& Hit, int32 HitRegistryGroup )
+{
+    int32 slotIdx = m_FirstFree;
+    if( slotIdx != INDEX_NONE )
+    {
+        m_FirstFree = m_Slots[slotIdx].m_NextFree;
+    }
+    else
+    {
+        slotIdx = m_Slots.AddDefaulted();
+    }
+
+    FSlot& slot = m_Slots[slotIdx];
+    slot.m_Hitbox.Emplace( FActiveHitbox{Hit, HitRegistryGroup} );
+    slot.m_NextFree = INDEX_NONE;
+
+    ++m_Num;
+
+    return FHitboxHandle{slotIdx, slot.m_Generation};
+}
+
+void FHitboxStore::Remove( FHitboxHandle Handle )
+{
+    if( !Find( Handle ) )
+    {
+        return;
+    }
+
+    FSlot& slot = m_Slots[Handle.m_Index];
+    slot.m_Hitbox.Reset();
+    slot.m_NextFree = m_FirstFree;
+    ++slot.m_Generation;
+
+    m_FirstFree = Handle.m_Index;
+    --m_Num;
+}
+
+FActiveHitbox* FHitboxStore::Find( FHitboxHandle Handle )
+{
+    if( !m_Slots.IsValidIndex( Handle.m_Index ) )
+    {
+        return nullptr;
+    }
+
+    FSlot& slot = m_Slots[Handle.m_Index];
+    return slot.m_Generation == Handle.m_Generation && slot.m_Hitbox.IsSet() ? &slot.m_Hitbox.GetValue() : nullptr;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FightingGame/Combat/HitData.h"
+
+/*
+ * Refers to one hitbox of a handler. A removed hitbox bumps the generation of its slot, so a stale handle never finds the hitbox
+ * that reused the slot.
+ */
+struct FHitboxHandle
+{
+    int32 m_Index       = INDEX_NONE;
+    uint32 m_Generation = 0;
+
+    FORCEINLINE bool IsValid() const { return m_Index != INDEX_NONE; }
+
+    friend bool operator==( const FHitboxHandle& Lhs, const FHitboxHandle& Rhs )
+    {
+        return Lhs.m_Index == Rhs.m_Index && Lhs.m_Generation == Rhs.m_Generation;
+    }
+
+    friend bool operator!=( const FHitboxHandle& Lhs, const FHitboxHandle& Rhs )
+    {
+        return !(Lhs == Rhs);
+    }
+};
+
+struct FActiveHitbox
+{
+    HitData m_Hit;
+
+    // Row of the hitbox group in the hit registry
+    int32 m_HitRegistryGroup = INDEX_NONE;
+
+    // Slot of the followed socket in the socket transform cache of the handler
+    int32 m_SocketIdx = INDEX_NONE;
+
+    // Hit a target since it was added, only read by the debug renderer
+    bool m_HasHit = false;
+
+    // Location on the previous resolve, unset until the hitbox is resolved once
+    TOptional<FVector> m_PreviousLocation;
+
+    /*
+     * Where a sweep to Location starts: the previous location, or Location itself on the first resolve
+     */
+    FORCEINLINE FVector AdvanceSweep( const FVector& Location )
+    {
+        const FVector start = m_PreviousLocation.Get( Location );
+        m_PreviousLocation  = Location;
+
+        return start;
+    }
+};
+
+/*
+ * Slot map of the active hitboxes, adding, removing and finding by handle are O(1).
+ * Freed slots are reused last freed first, so the iteration order only depends on the order of the adds and removes.
+ */
+class FIGHTINGGAME_API FHitboxStore
+{
+public:
+    FHitboxHandle Add( const HitData& Hit, int32 HitRegistryGroup );
+    void Remove( FHitboxHandle Handle );
+
+    FActiveHitbox* Find( FHitboxHandle Handle );
+
+    FORCEINLINE const FActiveHitbox* Find( FHitboxHandle Handle ) const
+    {
+        return const_cast<FHitboxStore*>( this )->Find( Handle );
+    }
+
+    FORCEINLINE int32 Num() const { return m_Num; }
+
+    /*
+     * Function( FHitboxHandle, FActiveHitbox& ), in slot order
+     */
+    template<typename FunctionType>
+    void ForEach( FunctionType Function );
+
+    template<typename FunctionType>
+    void ForEach( FunctionType Function ) const;
+
+private:
+    struct FSlot
+    {
+        TOptional<FActiveHitbox> m_Hitbox;
+        uint32 m_Generation = 0;
+        int32 m_NextFree    = INDEX_NONE;
+    };
+
+    TArray<FSlot> m_Slots;
+    int32 m_FirstFree = INDEX_NONE;
+    int32 m_Num       = 0;
+};
+
+template<typename FunctionType>
+void FHitboxStore::ForEach( FunctionType Function )
+{
+    for( int32 slotIdx = 0; slotIdx < m_Slots.Num(); ++slotIdx )
+    {
+        FSlot& slot = m_Slots[slotIdx];
+        if( slot.m_Hitbox.IsSet() )
+        {
+            Function( FHitboxHandle{slotIdx, slot.m_Generation}, slot.m_Hitbox.GetValue() );
+        }
+    }
+}
+
+template<typename FunctionType>
+void FHitboxStore::ForEach( FunctionType Function ) const
+{
+    for( int32 slotIdx = 0; slotIdx < m_Slots.Num(); ++slotIdx )
+    {
+        const FSlot& slot = m_Slots[slotIdx];
+        if( slot.m_Hitbox.IsSet() )
+        {
+            Function( FHitboxHandle{slotIdx, slot.m_Generation}, slot.m_Hitbox.GetValue() );
+        }
+    }
+}
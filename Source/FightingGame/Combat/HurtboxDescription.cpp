@@ -0,0 +1,3 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HurtboxDescription.h"
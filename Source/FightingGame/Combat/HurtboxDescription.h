@@ -0,0 +1,30 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "HurtboxDescription.generated.h"
+
+/*
+ * Capsule on the fighting plane relative to the owner facing right (Y forward, Z up), a circle when both ends are the same
+ */
+USTRUCT( BlueprintType )
+struct FHurtboxDescription
+{
+    GENERATED_BODY()
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Start (Relative to the owner)" )
+    FVector2D m_Start = FVector2D::ZeroVector;
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "End (Relative to the owner)" )
+    FVector2D m_End = FVector2D::ZeroVector;
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Radius" )
+    float m_Radius = 30.f;
+
+    friend bool operator==( const FHurtboxDescription& Lhs, const FHurtboxDescription& Rhs )
+    {
+        return Lhs.m_Start == Rhs.m_Start && Lhs.m_End == Rhs.m_End && Lhs.m_Radius == Rhs.m_Radius;
+    }
+};
@@ -2,126 +2,275 @@
 
 #include "InputSequenceResolver.h"
 
-void UInputSequenceResolver::Init( const TArray<TObjectPtr<UInputsSequence>>& InputsList, const TArray<TTuple<bool, bool>>& GroundedAirborneStates )
+void FCompiledInputRouteTable::Reset()
 {
-    ensureMsgf( InputsList.Num() == GroundedAirborneStates.Num(), TEXT("Inputs list size differs from grounded airborne states size") );
+    m_Transitions.Reset();
+    m_States.Reset();
 
-    for( int32 i = 0; i < InputsList.Num(); ++i )
+    AddState();
+}
+
+void FCompiledInputRouteTable::AddSequence( TObjectPtr<UInputsSequence> InputsSequence, int32 DefaultMaxStepFrames )
+{
+    const TArray<FMoveInputState>& inputs = InputsSequence->m_Inputs;
+    if( !ensureMsgf( !inputs.IsEmpty(), TEXT("Sequence [%s] has no inputs"), *InputsSequence->m_Name.ToString() ) )
     {
-        TObjectPtr<UInputsSequence> sequence = InputsList[i];
-        TArray<FMoveInputState>& inputs      = sequence->m_Inputs;
-        bool allowWhenGrounded               = GroundedAirborneStates[i].Key;
-        bool allowWhenAirborne               = GroundedAirborneStates[i].Value;
+        return;
+    }
 
-        auto startsWithSameInput = [&]( TSharedPtr<FInputResolverNode> _root )
-        {
-            ensureMsgf( !inputs.IsEmpty(), TEXT("Sequence [%s] has no inputs"), *sequence->m_Name.ToString() );
+    int32 state = 0;
+    for( int32 step = 0; step < inputs.Num(); ++step )
+    {
+        const FMoveInputState& input = inputs[step];
 
-            return _root->m_InputState == inputs[0];
-        };
+        // Clamped like the parallel matcher, which doesn't check a gap before the first step either
+        const int32 maxStepFrames = input.m_MaxFramesFromPrevious > 0 ? input.m_MaxFramesFromPrevious : DefaultMaxStepFrames;
+        const int32 stepFrames    = step > 0 ? FMath::Min( maxStepFrames, FParallelInputMatcher::s_MaxStepFrames ) : 0;
 
-        if( auto it = m_Trees.FindByPredicate( startsWithSameInput ) )
-        {
-            m_CurrentSequenceRoot = *it;
-        }
-        else
-        {
-            m_CurrentSequenceRoot = MakeShared<FInputResolverNode>( sequence, inputs[0], GroundedAirborneStates[0].Key,
-                                                                    GroundedAirborneStates[0].Value );
+        m_States[state].m_TimeoutFrames = FMath::Max( m_States[state].m_TimeoutFrames, stepFrames );
 
-            m_Trees.Emplace( m_CurrentSequenceRoot );
-        }
+        state = FindOrAddStepState( state, PackInputSymbol( input.m_InputEntry ), stepFrames );
+    }
 
-        for( int32 j = 1; j < inputs.Num(); ++j )
-        {
-            auto node = MakeShared<FInputResolverNode>( sequence, inputs[j], allowWhenGrounded, allowWhenAirborne );
+    // The best sequence allowed in the current stance is picked when the route ends here
+    TArray<TObjectPtr<UInputsSequence>, TInlineAllocator<1>>& acceptedSequences = m_States[state].m_AcceptedSequences;
 
-            InsertNode( node );
-        }
+    int32 insertIdx = 0;
+    while( insertIdx < acceptedSequences.Num() && acceptedSequences[insertIdx]->m_Priority <= InputsSequence->m_Priority )
+    {
+        ++insertIdx;
     }
+
+    acceptedSequences.Insert( InputsSequence, insertIdx );
 }
 
-void UInputSequenceResolver::RegisterInput( EInputEntry InputEntry )
+int32 FCompiledInputRouteTable::AddState()
 {
-    TArray<TSharedPtr<FInputResolverNode>> nodesArray = m_CurrentRouteNode ? m_CurrentRouteNode->m_Children : m_Trees;
+    const int32 stateIdx = m_States.Emplace();
+    ensureMsgf( stateIdx < MAX_int16, TEXT("Too many input route states") );
 
-    auto predSameInputEntry = [&InputEntry]( TSharedPtr<FInputResolverNode> _node )
+    const int32 firstTransitionIdx = m_Transitions.AddUninitialized( s_InputSymbolCount );
+    for( int32 i = 0; i < s_InputSymbolCount; ++i )
     {
-        // #TODO check state too
-        return _node->m_InputState.m_InputEntry == InputEntry;
-    };
+        m_Transitions[firstTransitionIdx + i] = s_NoTransition;
+    }
+
+    return stateIdx;
+}
+
+int32 FCompiledInputRouteTable::FindOrAddStepState( int32 State, int32 Symbol, int32 StepFrames )
+{
+    const int32 transitionIdx = State * s_InputSymbolCount + Symbol;
 
-    if( auto* it = nodesArray.FindByPredicate( predSameInputEntry ) )
+    // Alternatives are chained by increasing gap, so GetNextState finds the tightest one that fits first
+    int32 previousState = s_NoTransition;
+    int32 nextState     = m_Transitions[transitionIdx];
+    while( nextState != s_NoTransition && m_States[nextState].m_StepFrames < StepFrames )
     {
-        if( (*it)->m_Children.IsEmpty() )
-        {
-            m_InputRouteEndedDelegate.Broadcast( (*it)->m_InputsSequence );
+        previousState = nextState;
+        nextState     = m_States[nextState].m_NextAlternative;
+    }
 
-            ResetRouteTimer();
-            m_CurrentRouteNode = nullptr;
-        }
-        else
-        {
-            m_CurrentRouteNode = *it;
+    if( nextState != s_NoTransition && m_States[nextState].m_StepFrames == StepFrames )
+    {
+        return nextState;
+    }
 
-            ResetRouteTimer();
-            StartRouteTimer();
-        }
+    const int32 newState = AddState();
+
+    m_States[newState].m_StepFrames      = StepFrames;
+    m_States[newState].m_NextAlternative = static_cast<int16>(nextState);
+    m_States[State].m_IsLeaf             = false;
+
+    if( previousState == s_NoTransition )
+    {
+        m_Transitions[transitionIdx] = static_cast<int16>(newState);
     }
     else
     {
-        if( m_ResetRouteOnIncorrectInput )
-        {
-            ResetRouteTimer();
-            m_CurrentRouteNode = nullptr;
-        }
+        m_States[previousState].m_NextAlternative = static_cast<int16>(newState);
     }
+
+    return newState;
 }
 
-void UInputSequenceResolver::InsertNode( TSharedPtr<FInputResolverNode> Node )
+void FParallelInputMatcher::Build( const TArray<TObjectPtr<UInputsSequence>>& InputsList, int32 DefaultMaxStepFrames )
 {
-    if( !m_CurrentSequenceRoot )
+    int32 numBits = 0;
+    for( const TObjectPtr<UInputsSequence>& sequence : InputsList )
     {
-        m_CurrentSequenceRoot = Node;
+        numBits += sequence ? sequence->m_Inputs.Num() : 0;
     }
-    else
+
+    m_NumWords = FMath::Max( 1, FMath::DivideAndRoundUp( numBits, 64 ) );
+
+    m_SymbolMasks.Init( 0, s_InputSymbolCount * m_NumWords );
+    m_GapMasks.Init( 0, (s_MaxStepFrames + 2) * m_NumWords );
+    m_StartMask.Init( 0, m_NumWords );
+    m_AcceptMask.Init( 0, m_NumWords );
+    m_AcceptBitToSequence.Init( nullptr, m_NumWords * 64 );
+
+    int32 firstBit = 0;
+    for( const TObjectPtr<UInputsSequence>& sequence : InputsList )
     {
-        auto predIsSameInputState = [&]( TSharedPtr<FInputResolverNode> _child )
+        if( !sequence )
         {
-            return _child->m_InputState == Node->m_InputState;
-        };
+            continue;
+        }
 
-        if( auto* it = m_CurrentSequenceRoot->m_Children.FindByPredicate( predIsSameInputState ) )
+        const TArray<FMoveInputState>& inputs = sequence->m_Inputs;
+        for( int32 step = 0; step < inputs.Num(); ++step )
         {
-            m_CurrentSequenceRoot = *it;
-            InsertNode( Node );
+            const int32 bit = firstBit + step;
+
+            SetBit( m_SymbolMasks, PackInputSymbol( inputs[step].m_InputEntry ) * m_NumWords, bit );
+
+            if( step == 0 )
+            {
+                SetBit( m_StartMask, 0, bit );
+            }
+
+            if( step == inputs.Num() - 1 )
+            {
+                SetBit( m_AcceptMask, 0, bit );
+                m_AcceptBitToSequence[bit] = sequence;
+            }
+            else
+            {
+                const int32 nextStepFrames = inputs[step + 1].m_MaxFramesFromPrevious;
+                const int32 maxStepFrames  = FMath::Min( nextStepFrames > 0 ? nextStepFrames : DefaultMaxStepFrames, s_MaxStepFrames );
+
+                for( int32 frames = 0; frames <= maxStepFrames; ++frames )
+                {
+                    SetBit( m_GapMasks, frames * m_NumWords, bit );
+                }
+            }
         }
-        else
-        {
-            Node->m_Parent = m_CurrentSequenceRoot;
-            m_CurrentSequenceRoot->m_Children.Emplace( Node );
 
-            m_CurrentSequenceRoot = Node;
+        firstBit += inputs.Num();
+    }
+
+    Reset();
+}
+
+void FParallelInputMatcher::Reset()
+{
+    m_ActiveMask.Init( 0, m_NumWords );
+    m_LastInputFrame = 0;
+}
+
+void UInputSequenceResolver::Init( const TArray<TObjectPtr<UInputsSequence>>& InputsList )
+{
+    for( int32 stance = 0; stance < static_cast<int32>(UE_ARRAY_COUNT( m_StanceMatchers )); ++stance )
+    {
+        FStanceMatcher& stanceMatcher = m_StanceMatchers[stance];
+
+        stanceMatcher.m_RouteTable.Reset();
+        stanceMatcher.m_CurrentRouteState = 0;
+
+        for( const TObjectPtr<UInputsSequence>& inputsSequence : InputsList )
+        {
+            if( inputsSequence )
+            {
+                stanceMatcher.m_RouteTable.AddSequence( inputsSequence, m_DefaultMaxStepFrames );
+            }
         }
+
+        stanceMatcher.m_ParallelMatcher.Build( InputsList, m_DefaultMaxStepFrames );
+
+        m_StanceExcludedSequences[stance].Reset();
     }
 }
 
-void UInputSequenceResolver::StartRouteTimer()
+void UInputSequenceResolver::SetStanceFilters( const TArray<TObjectPtr<UInputsSequence>>& InputsList, const TArray<TTuple<bool, bool>>& GroundedAirborneStates )
 {
-    FTimerManager& timerManager = GetWorld()->GetTimerManager();
-    timerManager.SetTimer( m_RouteTimerHandle, this, &UInputSequenceResolver::OnRouteTimerEnded, m_RouteAutoResetTime );
+    ensureMsgf( InputsList.Num() == GroundedAirborneStates.Num(), TEXT("Inputs list size differs from grounded airborne states size") );
+
+    // Only the reported sequences are filtered, so moves registered mid-combo don't reset the progress of either stance
+    m_StanceExcludedSequences[0].Reset();
+    m_StanceExcludedSequences[1].Reset();
+
+    for( int32 i = 0; i < InputsList.Num(); ++i )
+    {
+        if( !InputsList[i] || !GroundedAirborneStates.IsValidIndex( i ) )
+        {
+            continue;
+        }
+
+        if( !GroundedAirborneStates[i].Key )
+        {
+            m_StanceExcludedSequences[0].Emplace( InputsList[i] );
+        }
+
+        if( !GroundedAirborneStates[i].Value )
+        {
+            m_StanceExcludedSequences[1].Emplace( InputsList[i] );
+        }
+    }
 }
 
-void UInputSequenceResolver::ResetRouteTimer()
+void UInputSequenceResolver::RegisterInput( EInputEntry InputEntry, uint32 Frame, bool IsAirborne )
 {
-    FTimerManager& timerManager = GetWorld()->GetTimerManager();
-    if( timerManager.IsTimerActive( m_RouteTimerHandle ) )
+    const int32 symbol = PackInputSymbol( InputEntry );
+
+    const int32 stance = IsAirborne ? 1 : 0;
+
+    if( m_MatcherMode == EInputSequenceMatcherMode::Parallel )
     {
-        timerManager.ClearTimer( m_RouteTimerHandle );
+        const TSet<TObjectPtr<UInputsSequence>>& excludedSequences = m_StanceExcludedSequences[stance];
+
+        m_StanceMatchers[stance].m_ParallelMatcher.Advance( symbol, Frame, [this, &excludedSequences]( TObjectPtr<UInputsSequence> _sequence )
+        {
+            if( !excludedSequences.Contains( _sequence ) )
+            {
+                m_InputRouteEndedDelegate.Broadcast( _sequence );
+            }
+        } );
+
+        return;
     }
+
+    RegisterRouteInput( stance, symbol, Frame );
 }
 
-void UInputSequenceResolver::OnRouteTimerEnded()
+void UInputSequenceResolver::RegisterRouteInput( int32 Stance, int32 Symbol, uint32 Frame )
 {
-    m_CurrentRouteNode = nullptr;
+    FStanceMatcher& stanceMatcher              = m_StanceMatchers[Stance];
+    const FCompiledInputRouteTable& routeTable = stanceMatcher.m_RouteTable;
+
+    // Expiry is checked lazily when the next input arrives, in input frames, so it does not depend on time dilation or hitches
+    if( stanceMatcher.m_CurrentRouteState != 0
+        && Frame - stanceMatcher.m_CurrentRouteFrame > static_cast<uint32>(routeTable.GetState( stanceMatcher.m_CurrentRouteState ).m_TimeoutFrames) )
+    {
+        stanceMatcher.m_CurrentRouteState = 0;
+    }
+
+    // Each step is checked against its own gap, not the largest one of the state
+    const int32 elapsedFrames = stanceMatcher.m_CurrentRouteState != 0
+                                    ? static_cast<int32>(FMath::Min<uint32>( Frame - stanceMatcher.m_CurrentRouteFrame, FParallelInputMatcher::s_MaxStepFrames + 1 ))
+                                    : 0;
+    const int32 nextState = routeTable.GetNextState( stanceMatcher.m_CurrentRouteState, Symbol, elapsedFrames );
+
+    if( nextState == FCompiledInputRouteTable::s_NoTransition )
+    {
+        if( m_ResetRouteOnIncorrectInput )
+        {
+            stanceMatcher.m_CurrentRouteState = 0;
+        }
+
+        return;
+    }
+
+    const FInputRouteState& state = routeTable.GetState( nextState );
+    for( const TObjectPtr<UInputsSequence>& acceptedSequence : state.m_AcceptedSequences )
+    {
+        if( !m_StanceExcludedSequences[Stance].Contains( acceptedSequence ) )
+        {
+            m_InputRouteEndedDelegate.Broadcast( acceptedSequence );
+            break;
+        }
+    }
+
+    stanceMatcher.m_CurrentRouteState = state.m_IsLeaf ? 0 : nextState;
+    stanceMatcher.m_CurrentRouteFrame = Frame;
 }
@@ -8,20 +8,151 @@
 #include "UObject/Object.h"
 #include "InputSequenceResolver.generated.h"
 
-struct FInputResolverNode
+static constexpr int32 s_InputSymbolCount = static_cast<int32>(EInputEntry::COUNT);
+
+/*
+ * Transition symbol of an input entry. The moves buffer only registers presses, so steps are matched on their entry alone
+ */
+FORCEINLINE int32 PackInputSymbol( EInputEntry InputEntry )
+{
+    // #TODO check the event too once the moves buffer registers releases
+    return static_cast<int32>(InputEntry);
+}
+
+struct FInputRouteState
+{
+    // Sequences sharing the exact same inputs end on the same state, sorted by priority, best (lowest) first
+    TArray<TObjectPtr<UInputsSequence>, TInlineAllocator<1>> m_AcceptedSequences;
+    bool m_IsLeaf = true;
+
+    /*
+     * Input frames the route can wait in this state for its next input, the largest gap among the outgoing steps
+     */
+    int32 m_TimeoutFrames = 0;
+
+    /*
+     * Max input frames of the step that enters this state, 0 for the first step of a sequence
+     */
+    int32 m_StepFrames = 0;
+
+    /*
+     * State entered by the same input from the same parent but with a larger step gap
+     */
+    int16 m_NextAlternative = INDEX_NONE;
+};
+
+/*
+ * All the registered sequences compiled into a single transition table (a DFA built from their prefix tree).
+ * Rows are states, columns are input symbols; state 0 is the root.
+ * Steps only share a state when their gaps match too, the rare steps that differ by gap alone are chained from the transition.
+ */
+struct FCompiledInputRouteTable
 {
-    FInputResolverNode( TObjectPtr<UInputsSequence> InputsSequence, FMoveInputState InputState, bool AllowWhenGrounded, bool AllowWhenAirborne )
-        : m_InputsSequence( InputsSequence ), m_InputState( InputState ), m_AllowWhenGrounded( AllowWhenGrounded ), m_AllowWhenAirborne( AllowWhenAirborne )
+    static constexpr int16 s_NoTransition = INDEX_NONE;
+
+    void Reset();
+    void AddSequence( TObjectPtr<UInputsSequence> InputsSequence, int32 DefaultMaxStepFrames );
+
+    /*
+     * The tightest step that still accepts an input ElapsedFrames after the previous one
+     */
+    FORCEINLINE int32 GetNextState( int32 State, int32 Symbol, int32 ElapsedFrames ) const
     {
+        checkSlow( Symbol >= 0 && Symbol < s_InputSymbolCount );
+
+        int32 nextState = m_Transitions[State * s_InputSymbolCount + Symbol];
+        while( nextState != s_NoTransition && m_States[nextState].m_StepFrames < ElapsedFrames )
+        {
+            nextState = m_States[nextState].m_NextAlternative;
+        }
+
+        return nextState;
     }
 
-    TObjectPtr<UInputsSequence> m_InputsSequence;
-    FMoveInputState m_InputState;
-    bool m_AllowWhenGrounded;
-    bool m_AllowWhenAirborne;
+    FORCEINLINE const FInputRouteState& GetState( int32 State ) const { return m_States[State]; }
+
+private:
+    TArray<int16> m_Transitions;
+    TArray<FInputRouteState> m_States;
 
-    TSharedPtr<FInputResolverNode> m_Parent = nullptr;
-    TArray<TSharedPtr<FInputResolverNode>> m_Children;
+    int32 AddState();
+    int32 FindOrAddStepState( int32 State, int32 Symbol, int32 StepFrames );
+};
+
+/*
+ * Shift-And matcher that advances every sequence at once: each sequence step owns one bit of a packed state vector,
+ * one input is a shift, an OR with the start bits and an AND with the symbol mask, per 64 steps of registered sequences.
+ * Overlapping sequences (e.g. 236 and 2369) are tracked simultaneously and all the ones completed by an input are reported.
+ */
+struct FParallelInputMatcher
+{
+    static constexpr int32 s_MaxStepFrames = 30;
+
+    void Build( const TArray<TObjectPtr<UInputsSequence>>& InputsList, int32 DefaultMaxStepFrames );
+    void Reset();
+
+    template<typename FunctionType>
+    void Advance( int32 Symbol, uint32 Frame, FunctionType OnSequenceCompleted );
+
+private:
+    int32 m_NumWords = 0;
+
+    TArray<uint64> m_SymbolMasks; // s_InputSymbolCount rows of m_NumWords
+    TArray<uint64> m_GapMasks;    // (s_MaxStepFrames + 2) rows, row N holds the steps that can still be extended N frames later
+    TArray<uint64> m_StartMask;
+    TArray<uint64> m_AcceptMask;
+    TArray<uint64> m_ActiveMask;
+
+    TArray<TObjectPtr<UInputsSequence>> m_AcceptBitToSequence;
+
+    uint32 m_LastInputFrame = 0;
+
+    FORCEINLINE static void SetBit( TArray<uint64>& Words, int32 RowOffset, int32 Bit )
+    {
+        Words[RowOffset + (Bit >> 6)] |= 1ull << (Bit & 63);
+    }
+};
+
+template<typename FunctionType>
+void FParallelInputMatcher::Advance( int32 Symbol, uint32 Frame, FunctionType OnSequenceCompleted )
+{
+    const int32 elapsedFrames = static_cast<int32>(FMath::Min<uint32>( Frame - m_LastInputFrame, s_MaxStepFrames + 1 ));
+    const uint64* gapMask     = &m_GapMasks[elapsedFrames * m_NumWords];
+    const uint64* symbolMask  = &m_SymbolMasks[Symbol * m_NumWords];
+
+    uint64 carry = 0;
+    for( int32 w = 0; w < m_NumWords; ++w )
+    {
+        const uint64 alive = m_ActiveMask[w] & gapMask[w];
+
+        m_ActiveMask[w] = (((alive << 1) | carry) | m_StartMask[w]) & symbolMask[w];
+        carry           = alive >> 63;
+
+        uint64 completed = m_ActiveMask[w] & m_AcceptMask[w];
+        while( completed )
+        {
+            const int32 bit = static_cast<int32>(FMath::CountTrailingZeros64( completed ));
+            OnSequenceCompleted( m_AcceptBitToSequence[(w << 6) + bit] );
+
+            completed &= completed - 1;
+        }
+    }
+
+    m_LastInputFrame = Frame;
+}
+
+UENUM()
+enum class EInputSequenceMatcherMode : uint8
+{
+    /*
+     * Follows a single route through the compiled table, resets on incorrect inputs
+     */
+    Route,
+
+    /*
+     * Tracks every sequence in parallel, overlapping sequences can complete on the same input
+     */
+    Parallel,
 };
 
 DECLARE_MULTICAST_DELEGATE_OneParam( FInputRouteEnded, TObjectPtr<UInputsSequence> )
@@ -34,26 +165,48 @@ class FIGHTINGGAME_API UInputSequenceResolver : public UObject
 public:
     FInputRouteEnded m_InputRouteEndedDelegate;
 
-    void Init( const TArray<TObjectPtr<UInputsSequence>>& InputsList, const TArray<TTuple<bool, bool>>& GroundedAirborneStates );
-    void RegisterInput( EInputEntry InputEntry );
+    /*
+     * Every sequence is compiled in both the grounded and the airborne matcher, and allowed in both stances until filtered
+     */
+    void Init( const TArray<TObjectPtr<UInputsSequence>>& InputsList );
+
+    /*
+     * Can be called at any time, the matchers and their progress are left untouched
+     */
+    void SetStanceFilters( const TArray<TObjectPtr<UInputsSequence>>& InputsList, const TArray<TTuple<bool, bool>>& GroundedAirborneStates );
+
+    /*
+     * Only the sequences allowed in the current stance are reported, each stance keeps its own progress
+     */
+    void RegisterInput( EInputEntry InputEntry, uint32 Frame, bool IsAirborne );
 
 protected:
-    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Route Auto-Reset Time (Seconds)" )
-    float m_RouteAutoResetTime = 0.1f;
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Matcher Mode" )
+    EInputSequenceMatcherMode m_MatcherMode = EInputSequenceMatcherMode::Route;
+
+    /*
+     * Max input frames between two steps of a sequence, used by the steps that do not specify their own.
+     * In route mode the current route expires once this many frames pass without its next input.
+     */
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Default Max Step Frames", meta = (ClampMin = "0", ClampMax = "30") )
+    int32 m_DefaultMaxStepFrames = 6;
 
     UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Reset Route On Incorrect Input" )
     bool m_ResetRouteOnIncorrectInput = true;
 
 private:
-    TArray<TSharedPtr<FInputResolverNode>> m_Trees;
-    TSharedPtr<FInputResolverNode> m_CurrentSequenceRoot = nullptr;
+    struct FStanceMatcher
+    {
+        FCompiledInputRouteTable m_RouteTable;
+        int32 m_CurrentRouteState  = 0;
+        uint32 m_CurrentRouteFrame = 0;
 
-    TSharedPtr<FInputResolverNode> m_CurrentRouteNode = nullptr;
+        FParallelInputMatcher m_ParallelMatcher;
+    };
 
-    FTimerHandle m_RouteTimerHandle;
+    // Indexed by IsAirborne
+    FStanceMatcher m_StanceMatchers[2];
+    TSet<TObjectPtr<UInputsSequence>> m_StanceExcludedSequences[2];
 
-    void InsertNode( TSharedPtr<FInputResolverNode> Node );
-    void StartRouteTimer();
-    void ResetRouteTimer();
-    void OnRouteTimerEnded();
+    void RegisterRouteInput( int32 Stance, int32 Symbol, uint32 Frame );
 };
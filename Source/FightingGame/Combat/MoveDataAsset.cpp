@@ -2,3 +2,182 @@
 
 #include "MoveDataAsset.h"
 
+#include "HitboxDescription.h"
+#include "HitboxNotifyState.h"
+#include "Animation/AnimMontage.h"
+
+#if WITH_EDITOR
+#include "BonePose.h"
+#include "Animation/AnimationPoseData.h"
+#include "Animation/AttributesRuntime.h"
+#include "Engine/Engine.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "FightingGame/Debugging/Debug.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+FVector FBakedHitboxTrack::Sample( float Time ) const
+{
+    const float frame    = FMath::Clamp( (Time - m_StartTime) * m_FrameRate, 0.f, static_cast<float>( m_Centers.Num() - 1 ) );
+    const int32 frameIdx = FMath::FloorToInt( frame );
+    const int32 nextIdx  = FMath::Min( frameIdx + 1, m_Centers.Num() - 1 );
+
+    return FVector( FMath::Lerp( m_Centers[frameIdx], m_Centers[nextIdx], frame - frameIdx ) );
+}
+
+bool FBakedHitboxTrack::MatchesWindow( const FAnimNotifyEvent& NotifyEvent ) const
+{
+    return FMath::IsNearlyEqual( m_StartTime, NotifyEvent.GetTriggerTime(), KINDA_SMALL_NUMBER ) && m_Centers.Num() == GetNumFrames( NotifyEvent, m_FrameRate );
+}
+
+int32 FBakedHitboxTrack::GetNumFrames( const FAnimNotifyEvent& NotifyEvent, float FrameRate )
+{
+    return FMath::FloorToInt( (NotifyEvent.GetEndTriggerTime() - NotifyEvent.GetTriggerTime()) * FrameRate ) + 1;
+}
+
+const FBakedHitboxTrack* UMoveDataAsset::FindBakedHitboxTrack( const UHitboxNotifyState* Notify, int32 HitboxIdx, FName Socket ) const
+{
+    return m_BakedHitboxTracks.FindByPredicate( [Notify, HitboxIdx, Socket]( const FBakedHitboxTrack& _track )
+    {
+        return _track.m_Notify == Notify && _track.m_HitboxIdx == HitboxIdx && _track.m_Socket == Socket;
+    } );
+}
+
+#if WITH_EDITOR
+void UMoveDataAsset::BakeHitboxTracks()
+{
+    m_BakedHitboxTracks.Reset();
+
+    if( !m_AnimationMontageAsset || m_AnimationMontageAsset->SlotAnimTracks.IsEmpty() )
+    {
+        return;
+    }
+
+    const USkeleton* skeleton = m_AnimationMontageAsset->GetSkeleton();
+    USkeletalMesh* mesh       = m_HitboxBakeMesh ? m_HitboxBakeMesh.Get() : skeleton ? skeleton->GetPreviewMesh() : nullptr;
+    if( !mesh )
+    {
+        FG_SLOG_WARN( FString::Printf( TEXT("Move [%s] has no mesh to bake the hitbox tracks with"), *GetName() ) );
+        return;
+    }
+
+    const FReferenceSkeleton& refSkeleton = mesh->GetRefSkeleton();
+
+    TArray<FBoneIndexType> requiredBones;
+    requiredBones.SetNumUninitialized( refSkeleton.GetNum() );
+    for( int32 boneIdx = 0; boneIdx < requiredBones.Num(); ++boneIdx )
+    {
+        requiredBones[boneIdx] = static_cast<FBoneIndexType>( boneIdx );
+    }
+
+    FBoneContainer boneContainer( requiredBones, FCurveEvaluationOption( false ), *mesh );
+
+    FMemMark mark( FMemStack::Get() );
+
+    FCompactPose pose;
+    pose.SetBoneContainer( &boneContainer );
+
+    FBlendedCurve curve;
+    curve.InitFrom( boneContainer );
+
+    UE::Anim::FStackAttributeContainer attributes;
+    FAnimationPoseData poseData( pose, curve, attributes );
+
+    // Moves play their montage on a single slot
+    const FAnimTrack& animTrack = m_AnimationMontageAsset->SlotAnimTracks[0].AnimTrack;
+    const bool lockRoot         = m_AnimationMontageAsset->HasRootMotion();
+
+    struct FBakedSocket
+    {
+        int32 m_TrackIdx;
+        FCompactPoseBoneIndex m_BoneIndex;
+        FTransform m_LocalTransform;
+    };
+
+    TArray<FBakedSocket> sockets;
+
+    for( const FAnimNotifyEvent& event : m_AnimationMontageAsset->Notifies )
+    {
+        UHitboxNotifyState* notify = Cast<UHitboxNotifyState>( event.NotifyStateClass );
+        if( !notify )
+        {
+            continue;
+        }
+
+        sockets.Reset();
+
+        const float startTime = event.GetTriggerTime();
+        const int32 numFrames = FBakedHitboxTrack::GetNumFrames( event, m_HitboxBakeRate );
+
+        for( int32 hitboxIdx = 0; hitboxIdx < notify->m_HitBoxes.Num(); ++hitboxIdx )
+        {
+            const FHitboxDescription& description = notify->m_HitBoxes[hitboxIdx];
+            if( description.m_UseLocation )
+            {
+                continue;
+            }
+
+            const FName socketNames[2] = { description.m_SocketName, description.m_SocketNameMirrored };
+
+            for( const FName socketName : socketNames )
+            {
+                if( socketName.IsNone() || FindBakedHitboxTrack( notify, hitboxIdx, socketName ) )
+                {
+                    continue;
+                }
+
+                // Same lookup as the socket transform cache, a name that is not a socket is a bone
+                const USkeletalMeshSocket* meshSocket = mesh->FindSocket( socketName );
+                const int32 boneIdx                   = refSkeleton.FindBoneIndex( meshSocket ? meshSocket->BoneName : socketName );
+                if( boneIdx == INDEX_NONE )
+                {
+                    FG_SLOG_WARN( FString::Printf( TEXT("Move [%s]: socket [%s] not found on [%s]"), *GetName(), *socketName.ToString(), *mesh->GetName() ) );
+                    continue;
+                }
+
+                FBakedHitboxTrack& track = m_BakedHitboxTracks.Emplace_GetRef();
+                track.m_Notify           = notify;
+                track.m_HitboxIdx        = hitboxIdx;
+                track.m_Socket           = socketName;
+                track.m_StartTime        = startTime;
+                track.m_FrameRate        = m_HitboxBakeRate;
+                track.m_Centers.SetNumUninitialized( numFrames );
+
+                sockets.Emplace( FBakedSocket{m_BakedHitboxTracks.Num() - 1,
+                                              boneContainer.MakeCompactPoseIndex( FMeshPoseBoneIndex( boneIdx ) ),
+                                              meshSocket ? meshSocket->GetSocketLocalTransform() : FTransform::Identity} );
+            }
+        }
+
+        // One pose per frame of the window, shared by all its sockets
+        for( int32 frameIdx = 0; frameIdx < numFrames && !sockets.IsEmpty(); ++frameIdx )
+        {
+            animTrack.GetAnimationPose( poseData, FAnimExtractContext( startTime + frameIdx / m_HitboxBakeRate ) );
+
+            // Root motion is extracted at runtime, the mesh doesn't see the root bone move
+            if( lockRoot )
+            {
+                pose[FCompactPoseBoneIndex( 0 )] = pose.GetRefPose( FCompactPoseBoneIndex( 0 ) );
+            }
+
+            FCSPose<FCompactPose> componentSpacePose;
+            componentSpacePose.InitPose( pose );
+
+            for( const FBakedSocket& socket : sockets )
+            {
+                const FTransform socketTransform = socket.m_LocalTransform * componentSpacePose.GetComponentSpaceTransform( socket.m_BoneIndex );
+                m_BakedHitboxTracks[socket.m_TrackIdx].m_Centers[frameIdx] = FVector3f( socketTransform.GetLocation() );
+            }
+        }
+    }
+}
+
+void UMoveDataAsset::PreSave( FObjectPreSaveContext SaveContext )
+{
+    Super::PreSave( SaveContext );
+
+    // Baked on every save and cook of the move, a montage edited since is picked up the next time
+    BakeHitboxTracks();
+}
+#endif
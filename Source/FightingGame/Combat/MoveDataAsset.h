@@ -4,12 +4,58 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "FightingGame/Combat/HurtboxDescription.h"
 #include "FightingGame/Combat/MoveInputState.h"
 #include "FightingGame/Input/InputsSequence.h"
 #include "MoveDataAsset.generated.h"
 
 enum class EInputEntry : uint8;
+class FObjectPreSaveContext;
+struct FAnimNotifyEvent;
 class UAnimationAsset;
+class UHitboxNotifyState;
+class USkeletalMesh;
+
+/*
+ * Socket followed by one hitbox of a notify window, sampled from the montage at a fixed rate
+ */
+USTRUCT()
+struct FBakedHitboxTrack
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TObjectPtr<UHitboxNotifyState> m_Notify = nullptr;
+
+    UPROPERTY()
+    int32 m_HitboxIdx = INDEX_NONE;
+
+    UPROPERTY()
+    FName m_Socket;
+
+    // Montage time of the first sample
+    UPROPERTY()
+    float m_StartTime = 0.f;
+
+    UPROPERTY()
+    float m_FrameRate = 60.f;
+
+    // Socket location in mesh component space, one per frame of the window
+    UPROPERTY()
+    TArray<FVector3f> m_Centers;
+
+    /*
+     * Mesh component space location at a montage time, interpolated between the two closest frames
+     */
+    FVector Sample( float Time ) const;
+
+    /*
+     * False once the notify window was moved or resized since the track was baked
+     */
+    bool MatchesWindow( const FAnimNotifyEvent& NotifyEvent ) const;
+
+    static int32 GetNumFrames( const FAnimNotifyEvent& NotifyEvent, float FrameRate );
+};
 
 UCLASS()
 class FIGHTINGGAME_API UMoveDataAsset : public UDataAsset
@@ -30,5 +76,32 @@ public:
     bool m_AllowWhenGrounded = true;
 
     UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Allow When Airborne" )
-    bool m_AllowWhenAirborne = false;
+    bool m_AllowWhenAirborne = true;
+
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Hurtboxes (Override the state ones)" )
+    TArray<FHurtboxDescription> m_Hurtboxes;
+
+    UPROPERTY( EditAnywhere, DisplayName = "Hitbox Bake Rate (FPS)", meta = (ClampMin = "1") )
+    float m_HitboxBakeRate = 60.f;
+
+    /*
+     * Mesh the sockets are baked with, the preview mesh of the montage skeleton if not set
+     */
+    UPROPERTY( EditAnywhere, DisplayName = "Hitbox Bake Mesh" )
+    TObjectPtr<USkeletalMesh> m_HitboxBakeMesh = nullptr;
+
+    /*
+     * Lets hitboxes follow their socket without evaluating the animation. Baked when the asset is saved, regular and mirrored sockets
+     */
+    UPROPERTY( VisibleAnywhere, DisplayName = "Baked Hitbox Tracks" )
+    TArray<FBakedHitboxTrack> m_BakedHitboxTracks;
+
+    const FBakedHitboxTrack* FindBakedHitboxTrack( const UHitboxNotifyState* Notify, int32 HitboxIdx, FName Socket ) const;
+
+#if WITH_EDITOR
+    UFUNCTION( CallInEditor, Category = "Hitboxes" )
+    void BakeHitboxTracks();
+
+    virtual void PreSave( FObjectPreSaveContext SaveContext ) override;
+#endif
 };
@@ -18,6 +18,12 @@ struct FIGHTINGGAME_API FMoveInputState
     UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Event" )
     TEnumAsByte<EInputEvent> m_InputEvent;
 
+    /*
+     * Max input frames allowed between the previous step and this one, 0 uses the resolver default. Both matchers clamp it to 30
+     */
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Max Frames From Previous", meta = (ClampMin = "0", ClampMax = "30") )
+    int32 m_MaxFramesFromPrevious = 0;
+
     bool operator==( const FMoveInputState& Other ) const
     {
         return m_InputEntry == Other.m_InputEntry && m_InputEvent == Other.m_InputEvent;
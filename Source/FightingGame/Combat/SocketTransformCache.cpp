@@ -0,0 +1,100 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "SocketTransformCache.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+int32 FSocketTransformCache::AddSocket( USkeletalMeshComponent* Mesh, FName Socket )
+{
+    int32 freeIdx = INDEX_NONE;
+
+    for( int32 socketIdx = 0; socketIdx < m_Sockets.Num(); ++socketIdx )
+    {
+        FSocket& socket = m_Sockets[socketIdx];
+        if( socket.m_RefCount == 0 )
+        {
+            freeIdx = freeIdx == INDEX_NONE ? socketIdx : freeIdx;
+        }
+        else if( socket.m_Mesh.Get() == Mesh && socket.m_Name == Socket )
+        {
+            ++socket.m_RefCount;
+            return socketIdx;
+        }
+    }
+
+    const int32 socketIdx = freeIdx != INDEX_NONE ? freeIdx : m_Sockets.AddDefaulted();
+
+    FSocket& socket   = m_Sockets[socketIdx];
+    socket.m_Mesh     = Mesh;
+    socket.m_Name     = Socket;
+    socket.m_RefCount = 1;
+
+    ResolveSocket( socket );
+    socket.m_WorldTransform = Mesh->GetComponentTransform();
+
+    return socketIdx;
+}
+
+void FSocketTransformCache::RemoveSocket( int32 SocketIdx )
+{
+    FSocket& socket = m_Sockets[SocketIdx];
+    if( ensureMsgf( socket.m_RefCount > 0, TEXT("Socket %s removed more times than added"), *socket.m_Name.ToString() ) && --socket.m_RefCount == 0 )
+    {
+        socket.m_Mesh = nullptr;
+    }
+}
+
+void FSocketTransformCache::Refresh()
+{
+    // Component to world of each mesh, computed once however many sockets it has
+    TArray<TPair<const USkeletalMeshComponent*, FTransform>, TInlineAllocator<2>> meshTransforms;
+
+    for( FSocket& socket : m_Sockets )
+    {
+        const USkeletalMeshComponent* mesh = socket.m_RefCount > 0 ? socket.m_Mesh.Get() : nullptr;
+        if( !mesh )
+        {
+            continue;
+        }
+
+        if( mesh->SkeletalMesh != socket.m_MeshAsset )
+        {
+            ResolveSocket( socket );
+        }
+
+        const TPair<const USkeletalMeshComponent*, FTransform>* meshTransform = meshTransforms.FindByPredicate(
+            [mesh]( const TPair<const USkeletalMeshComponent*, FTransform>& _pair )
+            {
+                return _pair.Key == mesh;
+            } );
+
+        if( !meshTransform )
+        {
+            meshTransform = &meshTransforms.Emplace_GetRef( mesh, mesh->GetComponentTransform() );
+        }
+
+        // Same fallback as GetSocketTransform, an unknown socket is the mesh itself
+        socket.m_WorldTransform = socket.m_BoneIndex != INDEX_NONE
+                                      ? socket.m_LocalTransform * mesh->GetBoneTransform( socket.m_BoneIndex, meshTransform->Value )
+                                      : meshTransform->Value;
+    }
+}
+
+void FSocketTransformCache::ResolveSocket( FSocket& Socket )
+{
+    const USkeletalMeshComponent* mesh = Socket.m_Mesh.Get();
+
+    Socket.m_MeshAsset      = mesh->SkeletalMesh;
+    Socket.m_LocalTransform = FTransform::Identity;
+
+    if( const USkeletalMeshSocket* meshSocket = mesh->GetSocketByName( Socket.m_Name ) )
+    {
+        Socket.m_BoneIndex      = mesh->GetBoneIndex( meshSocket->BoneName );
+        Socket.m_LocalTransform = meshSocket->GetSocketLocalTransform();
+    }
+    else
+    {
+        Socket.m_BoneIndex = mesh->GetBoneIndex( Socket.m_Name );
+    }
+}
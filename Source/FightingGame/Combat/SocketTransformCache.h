@@ -0,0 +1,51 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMesh;
+class USkeletalMeshComponent;
+
+/*
+ * World transforms of the mesh sockets followed by active hitboxes, computed once per refresh instead of once per hitbox.
+ * A socket is resolved to its bone index and local offset when it is added, refreshing then reads the bone transforms of each mesh with
+ * a single component to world transform. Refresh after the animation of the meshes is evaluated.
+ */
+class FIGHTINGGAME_API FSocketTransformCache
+{
+public:
+    /*
+     * Sockets are reference counted, adding a socket already in the cache returns its slot.
+     * A name that is not a socket of the mesh is looked up as a bone
+     */
+    int32 AddSocket( USkeletalMeshComponent* Mesh, FName Socket );
+    void RemoveSocket( int32 SocketIdx );
+
+    void Refresh();
+
+    /*
+     * Transform on the last refresh, the mesh transform when the socket was added since
+     */
+    FORCEINLINE const FTransform& GetSocketTransform( int32 SocketIdx ) const { return m_Sockets[SocketIdx].m_WorldTransform; }
+
+private:
+    struct FSocket
+    {
+        TWeakObjectPtr<USkeletalMeshComponent> m_Mesh;
+        FName m_Name;
+        int32 m_RefCount = 0;
+
+        // Resolved against this mesh asset, a mesh whose asset changed resolves its sockets again
+        const USkeletalMesh* m_MeshAsset = nullptr;
+        int32 m_BoneIndex                = INDEX_NONE;
+        FTransform m_LocalTransform;
+
+        FTransform m_WorldTransform;
+    };
+
+    // Free slots have no references, slots are never shrunk so the indices given out stay valid
+    TArray<FSocket> m_Sockets;
+
+    static void ResolveSocket( FSocket& Socket );
+};
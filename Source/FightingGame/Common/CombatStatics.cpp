@@ -46,6 +46,8 @@ bool UCombatStatics::ExecuteMove( AFightingCharacter* Character, UMoveDataAsset*
         Inst->AnimationRequested( Move->m_AnimationMontageAsset );
     }
 
+    Character->SetCurrentMove( Move );
+
     return true;
 }
 
@@ -97,8 +99,7 @@ bool UCombatStatics::IsOtherOnTheLeft( TObjectPtr<IFacingEntity> Me, TObjectPtr<
 }
 
 HitData UCombatStatics::GenerateHitDataFromHitboxDescription( TObjectPtr<AActor> HitboxOwner, TObjectPtr<USkeletalMeshComponent> SkeletalMesh,
-                                                              const FHitboxDescription& HitboxDesc, int32 Id, int32 GroupId,
-                                                              TArray<TObjectPtr<AActor>> AdditionalActorsToIgnore /*= {}*/ )
+                                                              const FHitboxDescription& HitboxDesc, int32 Id, int32 GroupId )
 {
     FName socketName;
     IFacingEntity* facingEntity = Cast<IFacingEntity>( HitboxOwner );
@@ -135,8 +136,7 @@ HitData UCombatStatics::GenerateHitDataFromHitboxDescription( TObjectPtr<AActor>
                     targetLocation,
                     Id,
                     GroupId,
-                    HitboxDesc.m_Priority,
-                    AdditionalActorsToIgnore );
+                    HitboxDesc.m_Priority );
 }
 
 FVector UCombatStatics::GetKnockbackFromOrientation( TObjectPtr<IFacingEntity> FacingEntity, float Orientation )
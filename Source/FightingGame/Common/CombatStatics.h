@@ -30,8 +30,7 @@ public:
     static bool IsOtherOnTheLeft( TObjectPtr<IFacingEntity> Me, TObjectPtr<IFacingEntity> Other );
 
     static HitData GenerateHitDataFromHitboxDescription( TObjectPtr<AActor> HitboxOwner, TObjectPtr<USkeletalMeshComponent> SkeletalMesh,
-                                                         const FHitboxDescription& HitboxDesc, int32 Id, int32 GroupId,
-                                                         TArray<TObjectPtr<AActor>> AdditionalActorsToIgnore = {} );
+                                                         const FHitboxDescription& HitboxDesc, int32 Id, int32 GroupId );
 
     static FVector GetKnockbackFromOrientation( TObjectPtr<IFacingEntity> FacingEntity, float Orientation );
 
@@ -4,11 +4,17 @@
 #include "GameFramework.h"
 
 #include "Manager.h"
+#include "FightingGame/Combat/CombatManager.h"
 #include "FightingGame/Debugging/Debug.h"
+#include "FightingGame/Input/InputManager.h"
 
 AGameFramework::AGameFramework()
 {
 	PrimaryActorTick.bCanEverTick = true;
+
+	// Frameworks that don't override the managers (e.g. BP_GameFramework) batch the input and the hitboxes of every character
+	m_Managers.Emplace( TEXT( "CombatManager" ), ACombatManager::StaticClass() );
+	m_Managers.Emplace( TEXT( "InputManager" ), AInputManager::StaticClass() );
 }
 
 void AGameFramework::Init()
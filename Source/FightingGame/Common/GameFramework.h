@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Manager.h"
 #include "FightingGame/Debugging/Debug.h"
+#include "FightingGame/FightingGameGameModeBase.h"
 #include "GameFramework/Actor.h"
 #include "GameFramework.generated.h"
 
@@ -37,6 +38,35 @@ public:
 		return nullptr;
 	}
 
+	/*
+	 * Same as GetManager, for the managers that are optional
+	 */
+	template<typename ManagerType>
+	ManagerType* FindManager() const
+	{
+		for( const TObjectPtr<AManager>& manager : m_ManagersInstances )
+		{
+			if( ManagerType* typedManager = Cast<ManagerType>( manager ) )
+			{
+				return typedManager;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/*
+	 * Manager of the framework owned by the world game mode, null without one (e.g. on clients)
+	 */
+	template<typename ManagerType>
+	static ManagerType* FindWorldManager( const UWorld* World )
+	{
+		const AFightingGameGameModeBase* gameMode = World ? World->GetAuthGameMode<AFightingGameGameModeBase>() : nullptr;
+		const AGameFramework* gameFramework       = gameMode ? gameMode->GetGameFramework().Get() : nullptr;
+
+		return gameFramework ? gameFramework->FindManager<ManagerType>() : nullptr;
+	}
+
 protected:
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Managers" )
 	TMap<FName, TSubclassOf<AManager>> m_Managers;
@@ -0,0 +1,208 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HitboxAllocationCounter.h"
+
+#if FG_COUNT_HITBOX_ALLOCATIONS
+
+#include <atomic>
+
+#include "Debug.h"
+#include "Engine/Engine.h"
+#include "Misc/CoreDelegates.h"
+
+namespace
+{
+	thread_local bool loc_CountAllocations = false;
+
+	// Read by every allocating thread
+	std::atomic<bool> loc_Counting( false );
+	std::atomic<uint64> loc_Allocations( 0 );
+	std::atomic<uint64> loc_AllocatedBytes( 0 );
+
+	// Game thread only
+	FMalloc* loc_InnerMalloc   = nullptr;
+	int32 loc_WarmUpFramesLeft = 0;
+	int32 loc_FramesLeft       = 0;
+	int32 loc_Frames           = 0;
+	FDelegateHandle loc_EndFrameHandle;
+
+	FORCEINLINE void loc_CountAllocation( SIZE_T Size )
+	{
+		if( loc_CountAllocations && loc_Counting.load( std::memory_order_relaxed ) )
+		{
+			loc_Allocations.fetch_add( 1, std::memory_order_relaxed );
+			loc_AllocatedBytes.fetch_add( Size, std::memory_order_relaxed );
+		}
+	}
+
+	/*
+	 * Forwards everything to the allocator it wraps, so blocks allocated before the wrap or after the unwrap are freed by the same allocator.
+	 * Never destroyed, another thread can still be inside one of its calls when the allocator is restored
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc( FMalloc* InnerMalloc )
+			: m_InnerMalloc( InnerMalloc )
+		{
+		}
+
+		virtual void* Malloc( SIZE_T Count, uint32 Alignment ) override
+		{
+			loc_CountAllocation( Count );
+			return m_InnerMalloc->Malloc( Count, Alignment );
+		}
+
+		virtual void* TryMalloc( SIZE_T Count, uint32 Alignment ) override
+		{
+			loc_CountAllocation( Count );
+			return m_InnerMalloc->TryMalloc( Count, Alignment );
+		}
+
+		virtual void* Realloc( void* Original, SIZE_T Count, uint32 Alignment ) override
+		{
+			// A realloc to zero is a free
+			if( Count > 0 )
+			{
+				loc_CountAllocation( Count );
+			}
+
+			return m_InnerMalloc->Realloc( Original, Count, Alignment );
+		}
+
+		virtual void* TryRealloc( void* Original, SIZE_T Count, uint32 Alignment ) override
+		{
+			if( Count > 0 )
+			{
+				loc_CountAllocation( Count );
+			}
+
+			return m_InnerMalloc->TryRealloc( Original, Count, Alignment );
+		}
+
+		virtual void Free( void* Original ) override { m_InnerMalloc->Free( Original ); }
+		virtual SIZE_T QuantizeSize( SIZE_T Count, uint32 Alignment ) override { return m_InnerMalloc->QuantizeSize( Count, Alignment ); }
+		virtual bool GetAllocationSize( void* Original, SIZE_T& SizeOut ) override { return m_InnerMalloc->GetAllocationSize( Original, SizeOut ); }
+		virtual void Trim( bool bTrimThreadCaches ) override { m_InnerMalloc->Trim( bTrimThreadCaches ); }
+		virtual void SetupTLSCachesOnCurrentThread() override { m_InnerMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { m_InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { m_InnerMalloc->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { m_InnerMalloc->UpdateStats(); }
+		virtual void GetAllocatorStats( FGenericMemoryStats& OutStats ) override { m_InnerMalloc->GetAllocatorStats( OutStats ); }
+		virtual void DumpAllocatorStats( FOutputDevice& Ar ) override { m_InnerMalloc->DumpAllocatorStats( Ar ); }
+		virtual bool IsInternallyThreadSafe() const override { return m_InnerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return m_InnerMalloc->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return m_InnerMalloc->GetDescriptiveName(); }
+
+	private:
+		FMalloc* m_InnerMalloc;
+	};
+
+	void loc_OnEndFrame()
+	{
+		if( loc_WarmUpFramesLeft > 0 )
+		{
+			if( --loc_WarmUpFramesLeft == 0 )
+			{
+				FHitboxAllocationCounter::BeginCounting();
+			}
+
+			return;
+		}
+
+		if( --loc_FramesLeft > 0 )
+		{
+			return;
+		}
+
+		FCoreDelegates::OnEndFrame.Remove( loc_EndFrameHandle );
+		loc_EndFrameHandle.Reset();
+
+		uint64 allocatedBytes    = 0;
+		const uint64 allocations = FHitboxAllocationCounter::EndCounting( &allocatedBytes );
+		if( allocations == 0 )
+		{
+			FG_SLOG_INFO( FString::Printf( TEXT("Hitbox path: no allocation over %d frames"), loc_Frames ) );
+		}
+		else
+		{
+			FG_SLOG_WARN( FString::Printf( TEXT("Hitbox path: %llu allocations (%llu bytes) over %d frames"), allocations, allocatedBytes, loc_Frames ) );
+		}
+	}
+}
+
+void FHitboxAllocationCounter::Start( int32 WarmUpFrames, int32 Frames )
+{
+	check( IsInGameThread() );
+
+	if( IsRunning() )
+	{
+		FG_SLOG_WARN( TEXT("Hitbox allocation counter is already running") );
+		return;
+	}
+
+	loc_Frames           = FMath::Max( Frames, 1 );
+	loc_FramesLeft       = loc_Frames;
+	loc_WarmUpFramesLeft = FMath::Max( WarmUpFrames, 0 );
+
+	if( loc_WarmUpFramesLeft == 0 )
+	{
+		BeginCounting();
+	}
+
+	loc_EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic( &loc_OnEndFrame );
+}
+
+void FHitboxAllocationCounter::BeginCounting()
+{
+	check( IsInGameThread() && !loc_InnerMalloc );
+
+	// Wraps whatever allocator is current, the wrapper is reused by the next runs
+	static FCountingMalloc* countingMalloc = nullptr;
+	if( !countingMalloc )
+	{
+		countingMalloc = new FCountingMalloc( GMalloc );
+	}
+
+	loc_InnerMalloc = GMalloc;
+	GMalloc         = countingMalloc;
+
+	loc_Allocations.store( 0 );
+	loc_AllocatedBytes.store( 0 );
+	loc_Counting.store( true );
+}
+
+uint64 FHitboxAllocationCounter::EndCounting( uint64* OutBytes )
+{
+	check( IsInGameThread() && loc_InnerMalloc );
+
+	loc_Counting.store( false );
+
+	GMalloc         = loc_InnerMalloc;
+	loc_InnerMalloc = nullptr;
+
+	if( OutBytes )
+	{
+		*OutBytes = loc_AllocatedBytes.load();
+	}
+
+	return loc_Allocations.load();
+}
+
+bool FHitboxAllocationCounter::IsRunning()
+{
+	return loc_EndFrameHandle.IsValid();
+}
+
+FHitboxAllocationScope::FHitboxAllocationScope( bool Count )
+	: m_PreviousCount( loc_CountAllocations )
+{
+	loc_CountAllocations = Count;
+}
+
+FHitboxAllocationScope::~FHitboxAllocationScope()
+{
+	loc_CountAllocations = m_PreviousCount;
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#define FG_COUNT_HITBOX_ALLOCATIONS (!UE_BUILD_SHIPPING)
+
+#if FG_COUNT_HITBOX_ALLOCATIONS
+
+/*
+ * Counts the heap allocations made inside counting hitbox allocation scopes.
+ * The global allocator is only wrapped while counting, the rest of the session allocates without the wrapper.
+ */
+class FIGHTINGGAME_API FHitboxAllocationCounter
+{
+public:
+	/*
+	 * Counts over a number of frames, allocations of the warm up frames are ignored. The result is reported once the frames are over
+	 */
+	static void Start( int32 WarmUpFrames, int32 Frames );
+
+	static bool IsRunning();
+
+	/*
+	 * Wraps the global allocator and counts until EndCounting, game thread only
+	 */
+	static void BeginCounting();
+
+	/*
+	 * Restores the global allocator, returns the allocations counted since BeginCounting
+	 */
+	static uint64 EndCounting( uint64* OutBytes = nullptr );
+};
+
+/*
+ * Allocations made on this thread while the innermost scope counts are attributed to the hitbox path.
+ * Gameplay callbacks run from the hitbox path (damage, knockback, delegates) open a scope that doesn't count.
+ */
+class FIGHTINGGAME_API FHitboxAllocationScope
+{
+public:
+	explicit FHitboxAllocationScope( bool Count );
+	~FHitboxAllocationScope();
+
+private:
+	bool m_PreviousCount;
+};
+
+#define FG_HITBOX_ALLOCATION_SCOPE() FHitboxAllocationScope PREPROCESSOR_JOIN( hitboxAllocationScope, __LINE__ )( true )
+#define FG_HITBOX_ALLOCATION_EXCLUDE() FHitboxAllocationScope PREPROCESSOR_JOIN( hitboxAllocationScope, __LINE__ )( false )
+
+#else
+
+#define FG_HITBOX_ALLOCATION_SCOPE()
+#define FG_HITBOX_ALLOCATION_EXCLUDE()
+
+#endif
@@ -0,0 +1,146 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "HitboxDebugRenderer.h"
+
+#if FG_HITBOX_DEBUG_RENDERER
+
+#include "Debug.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/ObjectKey.h"
+
+namespace
+{
+	int32 loc_ShowHitboxTraces = 0;
+	FG_CVAR_FLAG_DESC( CVarShowHitboxTraces, TEXT( "HitboxHandlerComponent.ShowHitboxTraces" ), loc_ShowHitboxTraces );
+
+	constexpr int32 loc_CircleSegments = 16;
+
+	const FColor loc_HitboxColor              = FColor::Red;
+	const FColor loc_HitboxHitColor           = FColor::Green;
+	const FColor loc_HurtboxColor             = FColor::Cyan;
+	const FColor loc_KnockbackColor           = FColor::White;
+	constexpr float loc_KnockbackLineThickness = 3.f;
+
+	TMap<TObjectKey<UWorld>, TUniquePtr<FHitboxDebugRenderer>> loc_Renderers;
+	FDelegateHandle loc_PostActorTickHandle;
+	FDelegateHandle loc_WorldCleanupHandle;
+
+	const TStaticArray<FVector2D, loc_CircleSegments + 1>& loc_GetUnitCircle()
+	{
+		static const TStaticArray<FVector2D, loc_CircleSegments + 1> unitCircle = []()
+		{
+			TStaticArray<FVector2D, loc_CircleSegments + 1> points;
+			for( int32 i = 0; i <= loc_CircleSegments; ++i )
+			{
+				const float angle = 2.f * PI * i / loc_CircleSegments;
+				points[i]         = FVector2D( FMath::Cos( angle ), FMath::Sin( angle ) );
+			}
+
+			return points;
+		}();
+
+		return unitCircle;
+	}
+}
+
+FHitboxDebugRenderer* FHitboxDebugRenderer::Get( UWorld* World )
+{
+	if( !loc_ShowHitboxTraces || !World )
+	{
+		return nullptr;
+	}
+
+	if( !loc_PostActorTickHandle.IsValid() )
+	{
+		loc_PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddStatic( &FHitboxDebugRenderer::OnWorldPostActorTick );
+		loc_WorldCleanupHandle  = FWorldDelegates::OnWorldCleanup.AddStatic( &FHitboxDebugRenderer::OnWorldCleanup );
+	}
+
+	TUniquePtr<FHitboxDebugRenderer>& renderer = loc_Renderers.FindOrAdd( World );
+	if( !renderer )
+	{
+		renderer = MakeUnique<FHitboxDebugRenderer>();
+	}
+
+	return renderer.Get();
+}
+
+void FHitboxDebugRenderer::AddHitbox( const FVector& Center, float Radius, const FVector& Knockback, bool HasHit )
+{
+	AddCircle( Center, Radius, HasHit ? loc_HitboxHitColor : loc_HitboxColor );
+
+	if( !Knockback.IsNearlyZero() )
+	{
+		AddLine( Center, Center + Knockback.GetSafeNormal() * Radius, loc_KnockbackColor, loc_KnockbackLineThickness );
+	}
+}
+
+void FHitboxDebugRenderer::AddHurtbox( float X, const FVector2D& Start, const FVector2D& End, float Radius )
+{
+	AddCircle( FVector( X, Start.X, Start.Y ), Radius, loc_HurtboxColor );
+
+	const FVector2D segment = End - Start;
+	if( segment.IsNearlyZero() )
+	{
+		return;
+	}
+
+	AddCircle( FVector( X, End.X, End.Y ), Radius, loc_HurtboxColor );
+
+	// The two sides, the caps inside the capsule are drawn too
+	const FVector2D offset = FVector2D( segment.Y, -segment.X ).GetSafeNormal() * Radius;
+	const float sides[2]   = { 1.f, -1.f };
+
+	for( const float side : sides )
+	{
+		const FVector2D start = Start + offset * side;
+		const FVector2D end   = End + offset * side;
+
+		AddLine( FVector( X, start.X, start.Y ), FVector( X, end.X, end.Y ), loc_HurtboxColor );
+	}
+}
+
+void FHitboxDebugRenderer::AddCircle( const FVector& Center, float Radius, const FColor& Color )
+{
+	const TStaticArray<FVector2D, loc_CircleSegments + 1>& unitCircle = loc_GetUnitCircle();
+
+	for( int32 i = 0; i < loc_CircleSegments; ++i )
+	{
+		const FVector start = Center + FVector( 0.f, unitCircle[i].X, unitCircle[i].Y ) * Radius;
+		const FVector end   = Center + FVector( 0.f, unitCircle[i + 1].X, unitCircle[i + 1].Y ) * Radius;
+
+		AddLine( start, end, Color );
+	}
+}
+
+void FHitboxDebugRenderer::AddLine( const FVector& Start, const FVector& End, const FColor& Color, float Thickness )
+{
+	// Zero lifetime, the batcher clears them on the next frame
+	m_Lines.Emplace( Start, End, Color, 0.f, Thickness, SDPG_Foreground );
+}
+
+void FHitboxDebugRenderer::Flush( UWorld* World )
+{
+	if( !m_Lines.IsEmpty() && World->ForegroundLineBatcher )
+	{
+		World->ForegroundLineBatcher->DrawLines( m_Lines );
+	}
+
+	m_Lines.Reset();
+}
+
+void FHitboxDebugRenderer::OnWorldPostActorTick( UWorld* World, ELevelTick /*TickType*/, float /*DeltaTime*/ )
+{
+	if( const TUniquePtr<FHitboxDebugRenderer>* renderer = loc_Renderers.Find( World ) )
+	{
+		(*renderer)->Flush( World );
+	}
+}
+
+void FHitboxDebugRenderer::OnWorldCleanup( UWorld* World, bool /*SessionEnded*/, bool /*CleanupResources*/ )
+{
+	loc_Renderers.Remove( World );
+}
+
+#endif
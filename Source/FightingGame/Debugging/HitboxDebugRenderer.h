@@ -0,0 +1,48 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#define FG_HITBOX_DEBUG_RENDERER (!UE_BUILD_SHIPPING)
+
+#if FG_HITBOX_DEBUG_RENDERER
+
+#include "Components/LineBatchComponent.h"
+
+/*
+ * Draws the hitboxes, hurtboxes and knockbacks of a world as one list of lines handed to the foreground line batcher after the actors ticked.
+ * One renderer per world, created the first time it is needed. Its line list is reused, nothing is spawned and nothing is allocated once
+ * it reached the size of a frame. Shown with HitboxHandlerComponent.ShowHitboxTraces.
+ */
+class FIGHTINGGAME_API FHitboxDebugRenderer
+{
+public:
+	/*
+	 * Null when the hitboxes are not shown, callers skip gathering what to draw
+	 */
+	static FHitboxDebugRenderer* Get( UWorld* World );
+
+	/*
+	 * Circle on the fighting plane and its knockback direction, green once it hit something
+	 */
+	void AddHitbox( const FVector& Center, float Radius, const FVector& Knockback, bool HasHit );
+
+	/*
+	 * Capsule on the fighting plane, drawn at depth X
+	 */
+	void AddHurtbox( float X, const FVector2D& Start, const FVector2D& End, float Radius );
+
+private:
+	TArray<FBatchedLine> m_Lines;
+
+	void AddCircle( const FVector& Center, float Radius, const FColor& Color );
+	void AddLine( const FVector& Start, const FVector& End, const FColor& Color, float Thickness = 0.f );
+
+	void Flush( UWorld* World );
+
+	static void OnWorldPostActorTick( UWorld* World, ELevelTick TickType, float DeltaTime );
+	static void OnWorldCleanup( UWorld* World, bool SessionEnded, bool CleanupResources );
+};
+
+#endif
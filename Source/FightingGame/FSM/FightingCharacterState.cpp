@@ -5,8 +5,11 @@
 #include "FightingCharacterStateTransition.h"
 #include "FightingGame/Character/FightingCharacter.h"
 #include "FightingGame/Animation/FightingCharacterAnimInstance.h"
+#include "FightingGame/Combat/CombatManager.h"
+#include "FightingGame/Combat/MoveDataAsset.h"
 #include "FightingGame/Common/CombatStatics.h"
 #include "FightingGame/Common/FSMStatics.h"
+#include "FightingGame/Common/GameFramework.h"
 #include "FightingGame/Input/MovesBufferComponent.h"
 
 void UFightingCharacterState::Init_Implementation()
@@ -27,6 +30,16 @@ void UFightingCharacterState::Init_Implementation()
         Instance->OnInit( m_OwnerCharacter );
         m_InstancedTransitions.Emplace( Pair.Key, Instance );
     }
+
+    // Matches the move inputs sequence only in the stances the move allows
+    m_OwnerCharacter->GetMovesBufferComponent()->RegisterMove( m_MoveToExecute );
+
+    m_CombatManager = AGameFramework::FindWorldManager<ACombatManager>( m_OwnerCharacter->GetWorld() );
+    if( m_CombatManager )
+    {
+        const TArray<FHurtboxDescription>& hurtboxes = m_MoveToExecute && !m_MoveToExecute->m_Hurtboxes.IsEmpty() ? m_MoveToExecute->m_Hurtboxes : m_Hurtboxes;
+        m_HurtboxSet                                 = hurtboxes.IsEmpty() ? INDEX_NONE : m_CombatManager->RegisterHurtboxSet( hurtboxes );
+    }
 }
 
 void UFightingCharacterState::Enter_Implementation()
@@ -39,6 +52,13 @@ void UFightingCharacterState::Enter_Implementation()
     m_CharacterGroundedHandle  = m_OwnerCharacter->m_GroundedDelegate.AddUObject( this, &UFightingCharacterState::OnCharacterGrounded );
     m_CharacterAirborneHandle  = m_OwnerCharacter->m_AirborneDelegate.AddUObject( this, &UFightingCharacterState::OnCharacterAirborne );
 
+    m_OwnerCharacter->GetMovesBufferComponent()->GetLatencyTracker().OnStateEntered();
+
+    if( m_CombatManager )
+    {
+        m_CombatManager->SetHurtboxSet( m_OwnerCharacter, m_HurtboxSet );
+    }
+
     if( m_MoveToExecute )
     {
         UCombatStatics::ExecuteMove( m_OwnerCharacter, m_MoveToExecute );
@@ -165,23 +185,17 @@ bool UFightingCharacterState::TryExecuteBufferedInputsSequences()
     bool canExecuteBufferedMoves = m_MoveToExecute != nullptr;
     if( canExecuteBufferedMoves )
     {
-        TArray<FInputsSequenceBufferEntry> inputsSequenceSnapshot;
-        m_OwnerCharacter->GetMovesBufferComponent()->GetInputsSequenceBufferSnapshot( inputsSequenceSnapshot, true );
+        UMovesBufferComponent* movesBuffer = m_OwnerCharacter->GetMovesBufferComponent();
 
-        if( !inputsSequenceSnapshot.IsEmpty() )
+        const int32 selectedInputsSequence = movesBuffer->GetBestBufferedInputsSequence();
+        if( selectedInputsSequence != INDEX_NONE )
         {
-            inputsSequenceSnapshot.Sort( []( const FInputsSequenceBufferEntry& A, const FInputsSequenceBufferEntry& B )
-            {
-                return A.m_Priority < B.m_Priority;
-            } );
-
-            FName selectedInputsSequence = inputsSequenceSnapshot[0].m_InputsSequenceName;
-            FName targetState            = GetDesiredFSMStateFromInputsSequence( selectedInputsSequence );
+            FName targetState = GetDesiredFSMStateFromInputsSequence( movesBuffer->GetInputsSequenceName( selectedInputsSequence ) );
 
             if( !targetState.IsNone() )
             {
-                // #TODO this does weird things!
-                m_OwnerCharacter->GetMovesBufferComponent()->InitInputsSequenceBuffer();
+                movesBuffer->IsInputsSequenceIdBuffered( selectedInputsSequence, true );
+                movesBuffer->InvalidateInputsSequenceBuffer();
 
                 UFSMStatics::SetState( m_OwnerCharacter->GetFSM(), targetState );
 
@@ -5,8 +5,10 @@
 #include "CoreMinimal.h"
 #include "StateBase.h"
 #include "FightingGame/Character/FightingCharacter.h"
+#include "FightingGame/Combat/HurtboxDescription.h"
 #include "FightingCharacterState.generated.h"
 
+class ACombatManager;
 class UFightingCharacterStateTransition;
 class UMoveDataAsset;
 class AFightingCharacter;
@@ -53,6 +55,12 @@ protected:
     UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Inputs Sequence Name To State Map" )
     TMap<FName, FName> m_InputsSequenceNameToStateMap;
 
+    /*
+     * Tested instead of the hurtbox components of the character while in the state, the move ones take precedence
+     */
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Hurtboxes (Empty to use the hurtbox components)" )
+    TArray<FHurtboxDescription> m_Hurtboxes;
+
     FName GetDesiredFSMStateFromInputsSequence( const FName& InputsSequenceName );
 
     UFUNCTION()
@@ -74,6 +82,12 @@ private:
     UPROPERTY()
     TMap<FName, TObjectPtr<UFightingCharacterStateTransition>> m_InstancedTransitions;
 
+    UPROPERTY()
+    TObjectPtr<ACombatManager> m_CombatManager = nullptr;
+
+    // Registered once, entering the state only selects it
+    int32 m_HurtboxSet = INDEX_NONE;
+
     FDelegateHandle m_CharacterHitLandedHandle;
     FDelegateHandle m_CharacterGroundedHandle;
     FDelegateHandle m_CharacterAirborneHandle;
@@ -5,13 +5,31 @@
 #include "FightingGame/Character/FightingCharacter.h"
 #include "FightingGame/Input/MovesBufferComponent.h"
 
+void UInputsSequenceTransition::OnInit( TObjectPtr<AFightingCharacter> Character )
+{
+    Super::OnInit( Character );
+
+    m_InputsSequenceId = m_Character->GetMovesBufferComponent()->GetInputsSequenceId( m_InputsSequenceName );
+}
+
+void UInputsSequenceTransition::OnStateEnter()
+{
+    Super::OnStateEnter();
+
+    // The moves buffer registry may not be built yet when the FSM is initialized
+    if( m_InputsSequenceId == INDEX_NONE )
+    {
+        m_InputsSequenceId = m_Character->GetMovesBufferComponent()->GetInputsSequenceId( m_InputsSequenceName );
+    }
+}
+
 bool UInputsSequenceTransition::CanPerformTransition()
 {
     if( m_RequireHitLanded )
     {
         if( m_Character->HasJustLandedHit() )
         {
-            if( m_Character->GetMovesBufferComponent()->IsInputsSequenceBuffered( m_InputsSequenceName ) )
+            if( m_Character->GetMovesBufferComponent()->IsInputsSequenceIdBuffered( m_InputsSequenceId ) )
             {
                 // #TODO is this correct? can this transition have the ownership of that value?
                 m_Character->ResetHasJustLandedHit();
@@ -23,7 +41,7 @@ bool UInputsSequenceTransition::CanPerformTransition()
     }
     else
     {
-        return m_Character->GetMovesBufferComponent()->IsInputsSequenceBuffered( m_InputsSequenceName );
+        return m_Character->GetMovesBufferComponent()->IsInputsSequenceIdBuffered( m_InputsSequenceId );
     }
 
     return false;
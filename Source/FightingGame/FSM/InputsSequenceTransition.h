@@ -19,5 +19,10 @@ public:
     UPROPERTY( EditAnywhere, DisplayName = "Require Hit Landed" )
     bool m_RequireHitLanded = false;
 
+    virtual void OnInit( TObjectPtr<AFightingCharacter> Character ) override;
+    virtual void OnStateEnter() override;
     virtual bool CanPerformTransition() override;
+
+private:
+    int32 m_InputsSequenceId = INDEX_NONE;
 };
@@ -16,7 +16,9 @@ void AFightingGameGameModeBase::BeginPlay()
 		m_CameraManager = Cast<ACameraManager>( CameraManagerActor );
 	}
 
-	m_GameFrameworkInstance = GetWorld()->SpawnActor<AGameFramework>();
+	UClass* gameFrameworkClass = m_GameFrameworkClass ? m_GameFrameworkClass.Get() : AGameFramework::StaticClass();
+
+	m_GameFrameworkInstance = GetWorld()->SpawnActor<AGameFramework>( gameFrameworkClass );
 	ensureMsgf( m_GameFrameworkInstance, TEXT("Could not spawn game framework") );
 
 	m_GameFrameworkInstance->Init();
@@ -5,6 +5,7 @@
 #include "FightingGame/Character/FightingCharacter.h"
 #include "FightingGame/Common/CombatStatics.h"
 #include "FightingGame/Debugging/Debug.h"
+#include "FightingGame/Input/MovesBufferComponent.h"
 #include "Kismet/GameplayStatics.h"
 
 void AFreeForAllGameMode::BeginPlay()
@@ -29,7 +30,17 @@ void AFreeForAllGameMode::SpawnCharacters()
         return A.m_Index < B.m_Index;
     } );
 
-    for( int32 i = 0; i < m_AdditionalPlayers + 1; ++i )
+    if( m_PlayerStarts.IsEmpty() )
+    {
+        FG_SLOG_ERR( TEXT("No indexed player start found, can't spawn characters") );
+        return;
+    }
+
+    ParseBotsCommandLine();
+
+    const int32 numPlayers = m_BotsOnly ? 0 : m_AdditionalPlayers + 1;
+
+    for( int32 i = 0; i < numPlayers; ++i )
     {
         TObjectPtr<APlayerController> player = i == 0 ? UGameplayStatics::GetPlayerController( world, 0 ) : UGameplayStatics::CreatePlayer( GetWorld() );
         //ABasePlayerState* playerState = Cast<ABasePlayerState>( player->PlayerState );
@@ -37,28 +48,24 @@ void AFreeForAllGameMode::SpawnCharacters()
 
         m_PlayerControllers.Emplace( player );
 
-        TObjectPtr<AIndexedPlayerStart> start    = m_PlayerStarts[i];
-        TObjectPtr<AFightingCharacter> character = GetWorld()->SpawnActor<AFightingCharacter>( m_CharacterClass, start->GetTransform() );
-        character->m_PlayerIndex                 = i;
-
-        m_Characters.Emplace( character );
-
-        player->Possess( character );
-
-        if( TObjectPtr<IFacingEntity> facingEntity = Cast<IFacingEntity>( character ) )
+        if( AFightingCharacter* character = SpawnCharacter( i ) )
         {
-            UCombatStatics::FaceLocation( facingEntity, FVector::ZeroVector );
+            player->Possess( character );
         }
-        else
+    }
+
+    // Bots get an AI controller so their movement component simulates like a possessed one, their inputs come from the moves buffer source
+    for( int32 i = numPlayers; i < numPlayers + m_BotPlayers; ++i )
+    {
+        if( AFightingCharacter* character = SpawnCharacter( i ) )
         {
-            FG_SLOG_ERR( TEXT("Cast to IFacingEntity from character failed") );
+            character->SpawnDefaultController();
+            character->GetMovesBufferComponent()->SetInputSource( CreateBotInputSource( m_BotPolicy, m_BotSeed + i, i, m_BotReplayRecordingName ) );
         }
     }
 
-    if( m_EnableCharactersAutoFacing && m_AdditionalPlayers == 1 )
+    if( m_EnableCharactersAutoFacing && m_Characters.Num() == 2 )
     {
-        ensureMsgf( m_Characters.Num() == 2, TEXT("Additional players var is set to 1 but the total number of characters is not 2") );
-
         m_Characters[0]->SetOpponentToFace( m_Characters[1] );
         m_Characters[1]->SetOpponentToFace( m_Characters[0] );
     }
@@ -68,6 +75,67 @@ void AFreeForAllGameMode::SpawnCharacters()
     EnablePlayersInput( true );
 }
 
+AFightingCharacter* AFreeForAllGameMode::SpawnCharacter( int32 PlayerIndex )
+{
+    // Player starts are shared once there are more characters than starts
+    const TObjectPtr<AIndexedPlayerStart> start = m_PlayerStarts[PlayerIndex % m_PlayerStarts.Num()];
+
+    FActorSpawnParameters spawnParameters;
+    spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    AFightingCharacter* character = GetWorld()->SpawnActor<AFightingCharacter>( m_CharacterClass, start->GetTransform(), spawnParameters );
+    if( !character )
+    {
+        FG_SLOG_ERR( FString::Printf( TEXT("Could not spawn character %d"), PlayerIndex ) );
+        return nullptr;
+    }
+
+    character->SetPlayerIndex( PlayerIndex );
+
+    m_Characters.Emplace( character );
+
+    if( TObjectPtr<IFacingEntity> facingEntity = Cast<IFacingEntity>( character ) )
+    {
+        UCombatStatics::FaceLocation( facingEntity, FVector::ZeroVector );
+    }
+    else
+    {
+        FG_SLOG_ERR( TEXT("Cast to IFacingEntity from character failed") );
+    }
+
+    return character;
+}
+
+void AFreeForAllGameMode::ParseBotsCommandLine()
+{
+    const TCHAR* commandLine = FCommandLine::Get();
+
+    FParse::Value( commandLine, TEXT( "FGBots=" ), m_BotPlayers );
+    FParse::Value( commandLine, TEXT( "FGBotSeed=" ), m_BotSeed );
+    FParse::Value( commandLine, TEXT( "FGBotReplay=" ), m_BotReplayRecordingName );
+
+    FString botPolicy;
+    if( FParse::Value( commandLine, TEXT( "FGBotPolicy=" ), botPolicy ) )
+    {
+        const int64 policyValue = StaticEnum<EBotInputPolicy>()->GetValueByNameString( botPolicy );
+        if( policyValue != INDEX_NONE )
+        {
+            m_BotPolicy = static_cast<EBotInputPolicy>(policyValue);
+        }
+        else
+        {
+            FG_SLOG_WARN( FString::Printf( TEXT("Unknown bot policy [%s]"), *botPolicy ) );
+        }
+    }
+
+    if( FParse::Param( commandLine, TEXT( "FGBotsOnly" ) ) )
+    {
+        m_BotsOnly = true;
+    }
+
+    m_BotPlayers = FMath::Max( m_BotPlayers, 0 );
+}
+
 void AFreeForAllGameMode::EnablePlayersInput( bool Enable )
 {
     for( APlayerController* player : m_PlayerControllers )
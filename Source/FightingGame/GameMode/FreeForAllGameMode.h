@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "FightingGame/FightingGameGameModeBase.h"
+#include "FightingGame/Input/BotInputSource.h"
 #include "FreeForAllGameMode.generated.h"
 
 class AIndexedPlayerStart;
@@ -24,6 +25,26 @@ protected:
     UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Additional Players" )
     int m_AdditionalPlayers = 0;
 
+    /*
+     * Characters driven by a bot input source, spawned after the players.
+     * Overridden on the command line by -FGBots=<Count> -FGBotPolicy=<Mash|MotionSpam|Replay> -FGBotReplay=<RecordingName> -FGBotSeed=<Seed>,
+     * -FGBotsOnly skips the player characters so a headless session runs without anyone at the controllers.
+     */
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Bots, DisplayName = "Bot Players" )
+    int32 m_BotPlayers = 0;
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Bots, DisplayName = "Bot Policy" )
+    EBotInputPolicy m_BotPolicy = EBotInputPolicy::Mash;
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Bots, DisplayName = "Bot Replay Recording Name" )
+    FString m_BotReplayRecordingName;
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Bots, DisplayName = "Bot Seed" )
+    int32 m_BotSeed = 0;
+
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Bots, DisplayName = "Bots Only" )
+    bool m_BotsOnly = false;
+
     /*
      * This only works with exactly 2 players
      */
@@ -36,5 +57,7 @@ private:
     TArray<TObjectPtr<AFightingCharacter>> m_Characters;
 
     void SpawnCharacters();
+    AFightingCharacter* SpawnCharacter( int32 PlayerIndex );
+    void ParseBotsCommandLine();
     void EnablePlayersInput( bool Enable );
 };
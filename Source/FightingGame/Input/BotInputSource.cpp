@@ -0,0 +1,171 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "BotInputSource.h"
+
+#include "Engine/Engine.h"
+#include "FightingGame/Debugging/Debug.h"
+
+namespace
+{
+    // Numpad notation, 5 is neutral
+    const TCHAR* const loc_Motions[] =
+    {
+        TEXT( "236" ),
+        TEXT( "214" ),
+        TEXT( "623" ),
+        TEXT( "421" ),
+        TEXT( "41236" ),
+        TEXT( "63214" ),
+        TEXT( "252" ),
+    };
+
+    void SetStickDirection( FRawInputFrame& Frame, int32 NumpadDirection )
+    {
+        Frame.m_StickX = static_cast<int8>(((NumpadDirection - 1) % 3 - 1) * 127);
+        Frame.m_StickY = static_cast<int8>(((NumpadDirection - 1) / 3 - 1) * 127);
+    }
+
+    ERawInputButton GetRandomButton( FRandomStream& Random )
+    {
+        return static_cast<ERawInputButton>(Random.RandHelper( static_cast<int32>(ERawInputButton::COUNT) ));
+    }
+}
+
+TSharedRef<IInputFrameSource> CreateBotInputSource( EBotInputPolicy Policy, int32 Seed, int32 PlayerIndex, const FString& ReplayRecordingName )
+{
+    switch( Policy )
+    {
+        case EBotInputPolicy::MotionSpam:
+            return MakeShared<FMotionSpamBotInputSource>( Seed );
+
+        case EBotInputPolicy::Replay:
+        {
+            // Bots beyond the recorded players replay the first one
+            TSharedRef<FInputRecording> recording = MakeShared<FInputRecording>();
+            if( recording->LoadFromFile( FInputRecording::GetRecordingFilePath( ReplayRecordingName, PlayerIndex ) )
+                || recording->LoadFromFile( FInputRecording::GetRecordingFilePath( ReplayRecordingName, 0 ) ) )
+            {
+                if( recording->GetNumFrames() > 0 )
+                {
+                    // Offset each bot so they don't all replay the same frame
+                    return MakeShared<FLoopingPlaybackSource>( recording, static_cast<uint32>(Seed) % recording->GetNumFrames() );
+                }
+            }
+
+            FG_SLOG_WARN( FString::Printf( TEXT("Could not load input recording [%s] for bot %d, mashing instead"), *ReplayRecordingName, PlayerIndex ) );
+            return MakeShared<FMashBotInputSource>( Seed );
+        }
+
+        case EBotInputPolicy::Mash:
+        default:
+            return MakeShared<FMashBotInputSource>( Seed );
+    }
+}
+
+FMashBotInputSource::FMashBotInputSource( int32 Seed )
+    : m_Random( Seed )
+{
+}
+
+bool FMashBotInputSource::PollFrame( FRawInputFrame& OutFrame )
+{
+    OutFrame        = FRawInputFrame();
+    OutFrame.m_Held = m_JumpFramesLeft > 0 ? GetRawInputButtonBit( ERawInputButton::Jump ) : 0;
+
+    if( m_StickFramesLeft-- <= 0 )
+    {
+        m_StickDirection  = m_Random.RandRange( 1, 9 );
+        m_StickFramesLeft = m_Random.RandRange( 1, s_MaxHoldFrames );
+    }
+
+    SetStickDirection( OutFrame, m_StickDirection );
+
+    if( m_JumpFramesLeft > 0 && --m_JumpFramesLeft == 0 )
+    {
+        OutFrame.Release( ERawInputButton::Jump );
+    }
+
+    if( m_Random.FRand() < s_PressChance )
+    {
+        const ERawInputButton button = GetRandomButton( m_Random );
+
+        // A held jump has to be released before it can be pressed again, the other buttons are tapped
+        if( button != ERawInputButton::Jump )
+        {
+            OutFrame.Press( button );
+            OutFrame.Release( button );
+        }
+        else if( m_JumpFramesLeft == 0 )
+        {
+            OutFrame.Press( button );
+            m_JumpFramesLeft = m_Random.RandRange( 1, s_MaxHoldFrames );
+        }
+    }
+
+    return true;
+}
+
+FMotionSpamBotInputSource::FMotionSpamBotInputSource( int32 Seed )
+    : m_Random( Seed )
+{
+}
+
+bool FMotionSpamBotInputSource::PollFrame( FRawInputFrame& OutFrame )
+{
+    OutFrame = FRawInputFrame();
+
+    if( m_NeutralFramesLeft > 0 )
+    {
+        --m_NeutralFramesLeft;
+        return true;
+    }
+
+    if( !m_Motion )
+    {
+        m_Motion         = loc_Motions[m_Random.RandHelper( static_cast<int32>(UE_ARRAY_COUNT( loc_Motions )) )];
+        m_Step           = 0;
+        m_StepFramesLeft = s_StepFrames;
+    }
+
+    SetStickDirection( OutFrame, m_Motion[m_Step] - TEXT( '0' ) );
+
+    if( --m_StepFramesLeft == 0 )
+    {
+        m_StepFramesLeft = s_StepFrames;
+
+        // The button lands on the last direction of the motion
+        if( m_Motion[++m_Step] == TEXT( '\0' ) )
+        {
+            const ERawInputButton button = m_Random.FRand() < .5f ? ERawInputButton::Attack : ERawInputButton::Special;
+            OutFrame.Press( button );
+            OutFrame.Release( button );
+
+            m_Motion            = nullptr;
+            m_NeutralFramesLeft = m_Random.RandRange( s_MinNeutralFrames, s_MaxNeutralFrames );
+        }
+    }
+
+    return true;
+}
+
+FLoopingPlaybackSource::FLoopingPlaybackSource( TSharedRef<FInputRecording> Recording, uint32 StartFrame )
+    : m_Recording( Recording )
+{
+    m_Reader.Emplace( m_Recording.Get(), StartFrame );
+}
+
+bool FLoopingPlaybackSource::PollFrame( FRawInputFrame& OutFrame )
+{
+    if( m_Reader->Next( OutFrame ) )
+    {
+        return true;
+    }
+
+    if( m_Recording->GetNumFrames() == 0 )
+    {
+        return false;
+    }
+
+    m_Reader.Emplace( m_Recording.Get(), 0 );
+    return m_Reader->Next( OutFrame );
+}
@@ -0,0 +1,87 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InputRecording.h"
+#include "RawInputFrame.h"
+#include "BotInputSource.generated.h"
+
+UENUM( BlueprintType )
+enum class EBotInputPolicy : uint8
+{
+    /*
+     * Random buttons and stick directions
+     */
+    Mash,
+
+    /*
+     * Motion inputs (quarter circles, dragon punches, half circles) ending on a button
+     */
+    MotionSpam,
+
+    /*
+     * Loops a recorded session, falls back to mashing when the recording can't be loaded
+     */
+    Replay,
+};
+
+/*
+ * Bot sources never run out, they drive their moves buffer until it is given another source.
+ * Frames only depend on the seed, so a soak run can be reproduced.
+ */
+FIGHTINGGAME_API TSharedRef<IInputFrameSource> CreateBotInputSource( EBotInputPolicy Policy, int32 Seed, int32 PlayerIndex, const FString& ReplayRecordingName );
+
+class FIGHTINGGAME_API FMashBotInputSource : public IInputFrameSource
+{
+public:
+    explicit FMashBotInputSource( int32 Seed );
+
+    virtual bool PollFrame( FRawInputFrame& OutFrame ) override;
+
+private:
+    static constexpr float s_PressChance   = .2f;
+    static constexpr int32 s_MaxHoldFrames = 12;
+
+    FRandomStream m_Random;
+
+    int32 m_StickDirection  = 5;
+    int32 m_StickFramesLeft = 0;
+    int32 m_JumpFramesLeft  = 0;
+};
+
+class FIGHTINGGAME_API FMotionSpamBotInputSource : public IInputFrameSource
+{
+public:
+    explicit FMotionSpamBotInputSource( int32 Seed );
+
+    virtual bool PollFrame( FRawInputFrame& OutFrame ) override;
+
+private:
+    static constexpr int32 s_StepFrames       = 2;
+    static constexpr int32 s_MinNeutralFrames = 4;
+    static constexpr int32 s_MaxNeutralFrames = 16;
+
+    FRandomStream m_Random;
+
+    const TCHAR* m_Motion     = nullptr;
+    int32 m_Step              = 0;
+    int32 m_StepFramesLeft    = 0;
+    int32 m_NeutralFramesLeft = 0;
+};
+
+/*
+ * Same as FInputPlaybackSource, restarting from the first frame once the recording is over
+ */
+class FIGHTINGGAME_API FLoopingPlaybackSource : public IInputFrameSource
+{
+public:
+    FLoopingPlaybackSource( TSharedRef<FInputRecording> Recording, uint32 StartFrame );
+
+    virtual bool PollFrame( FRawInputFrame& OutFrame ) override;
+
+private:
+    TSharedRef<FInputRecording> m_Recording;
+    TOptional<FInputRecording::FReader> m_Reader;
+};
@@ -0,0 +1,182 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "ConsumableInputBuffer.h"
+
+void FConsumableInputBuffer::Init( int32 NumKeys, TConstArrayView<uint8> KeyRanks )
+{
+    ensureMsgf( NumKeys >= 0 && NumKeys <= MAX_int16, TEXT("Invalid number of keys for consumable input buffer: %d"), NumKeys );
+    ensureMsgf( KeyRanks.Num() == 0 || KeyRanks.Num() == NumKeys, TEXT("Consumable input buffer expects one rank per key") );
+
+    m_Slots.Init( s_MaxCapacity, FEntry{s_NoKey, 0} );
+
+    m_UnconsumedMasks.Init( 0, NumKeys );
+    m_LastFrames.Init( 0, NumKeys );
+
+    uint8 maxRank = 0;
+    m_KeyRanks.Init( 0, NumKeys );
+    for( int32 i = 0; i < KeyRanks.Num() && i < NumKeys; ++i )
+    {
+        checkf( KeyRanks[i] < s_MaxRanks, TEXT("Rank %d out of the %d consumable input buffer ranks"), KeyRanks[i], s_MaxRanks );
+
+        m_KeyRanks[i] = KeyRanks[i];
+        maxRank       = FMath::Max( maxRank, m_KeyRanks[i] );
+    }
+
+    m_RankMasks.Init( 0, maxRank + 1 );
+    m_NonEmptyRanks = 0;
+}
+
+void FConsumableInputBuffer::Reset()
+{
+    m_Slots.Reset( FEntry{s_NoKey, 0} );
+
+    for( uint64& mask : m_UnconsumedMasks )
+    {
+        mask = 0;
+    }
+
+    for( uint32& frame : m_LastFrames )
+    {
+        frame = 0;
+    }
+
+    for( uint64& mask : m_RankMasks )
+    {
+        mask = 0;
+    }
+
+    m_NonEmptyRanks = 0;
+}
+
+void FConsumableInputBuffer::Push( int32 Key, uint32 Frame )
+{
+    checkSlow( m_UnconsumedMasks.IsValidIndex( Key ) );
+
+    const uint32 slotIndex = m_Slots.GetNextIndex();
+
+    // The slot being overwritten may still hold an unconsumed occurrence of another key
+    const int16 evictedKey = m_Slots.GetSlotAt( slotIndex ).m_Value.m_Key;
+    if( evictedKey != s_NoKey )
+    {
+        ClearSlot( evictedKey, slotIndex );
+    }
+
+    m_Slots.Push( FEntry{static_cast<int16>(Key), m_Generation}, Frame );
+
+    const uint64 slotBit = 1ull << slotIndex;
+    const uint8 rank     = m_KeyRanks[Key];
+
+    m_UnconsumedMasks[Key] |= slotBit;
+    m_LastFrames[Key] = Frame;
+
+    m_RankMasks[rank] |= slotBit;
+    m_NonEmptyRanks |= 1ull << rank;
+}
+
+int32 FConsumableInputBuffer::FindNewestSlot( uint64 SlotMask ) const
+{
+    if( SlotMask == 0 )
+    {
+        return INDEX_NONE;
+    }
+
+    // Rotate the mask so bits are ordered by age, the oldest slot lands on bit 0 and the newest on the highest bit
+    const uint32 capacity = m_Slots.GetCapacity();
+    const uint32 head     = m_Slots.GetNextIndex();
+    const uint64 ageMask  = capacity == 64 ? ~0ull : (1ull << capacity) - 1;
+    const uint64 byAge    = head == 0 ? SlotMask : ((SlotMask >> head) | (SlotMask << (capacity - head))) & ageMask;
+
+    return static_cast<int32>((FMath::FloorLog2_64( byAge ) + head) & (capacity - 1));
+}
+
+bool FConsumableInputBuffer::IsAlive( int32 SlotIndex, uint32 CurrentFrame, uint32 WindowFrames ) const
+{
+    const auto& slot = m_Slots.GetSlotAt( SlotIndex );
+    return slot.m_Value.m_Generation == m_Generation && m_Slots.IsWithinFrames( slot, CurrentFrame, WindowFrames );
+}
+
+void FConsumableInputBuffer::ClearSlot( int32 Key, uint32 SlotIndex )
+{
+    const uint64 slotBit = 1ull << SlotIndex;
+    const uint8 rank     = m_KeyRanks[Key];
+
+    m_UnconsumedMasks[Key] &= ~slotBit;
+
+    m_RankMasks[rank] &= ~slotBit;
+    if( m_RankMasks[rank] == 0 )
+    {
+        m_NonEmptyRanks &= ~(1ull << rank);
+    }
+}
+
+bool FConsumableInputBuffer::Contains( int32 Key, uint32 CurrentFrame, uint32 WindowFrames ) const
+{
+    checkSlow( m_UnconsumedMasks.IsValidIndex( Key ) );
+
+    if( m_UnconsumedMasks[Key] == 0 || CurrentFrame - m_LastFrames[Key] >= WindowFrames )
+    {
+        return false;
+    }
+
+    return IsAlive( FindNewestSlot( m_UnconsumedMasks[Key] ), CurrentFrame, WindowFrames );
+}
+
+bool FConsumableInputBuffer::Consume( int32 Key, uint32 CurrentFrame, uint32 WindowFrames )
+{
+    checkSlow( m_UnconsumedMasks.IsValidIndex( Key ) );
+
+    if( m_UnconsumedMasks[Key] == 0 || CurrentFrame - m_LastFrames[Key] >= WindowFrames )
+    {
+        return false;
+    }
+
+    const int32 slotIndex = FindNewestSlot( m_UnconsumedMasks[Key] );
+    if( !IsAlive( slotIndex, CurrentFrame, WindowFrames ) )
+    {
+        return false;
+    }
+
+    ClearSlot( Key, slotIndex );
+
+    return true;
+}
+
+void FConsumableInputBuffer::ConsumeAll( int32 Key )
+{
+    checkSlow( m_UnconsumedMasks.IsValidIndex( Key ) );
+
+    uint64 mask = m_UnconsumedMasks[Key];
+    while( mask != 0 )
+    {
+        const uint32 slotIndex = static_cast<uint32>(FMath::CountTrailingZeros64( mask ));
+        mask &= mask - 1;
+
+        ClearSlot( Key, slotIndex );
+    }
+}
+
+int32 FConsumableInputBuffer::FindBestRanked( uint32 CurrentFrame, uint32 WindowFrames )
+{
+    while( m_NonEmptyRanks != 0 )
+    {
+        const uint32 rank     = static_cast<uint32>(FMath::CountTrailingZeros64( m_NonEmptyRanks ));
+        const int32 slotIndex = FindNewestSlot( m_RankMasks[rank] );
+
+        if( IsAlive( slotIndex, CurrentFrame, WindowFrames ) )
+        {
+            return m_Slots.GetSlotAt( slotIndex ).m_Value.m_Key;
+        }
+
+        // The newest occurrence of this rank expired or was invalidated, so every older one did too
+        uint64 staleMask = m_RankMasks[rank];
+        while( staleMask != 0 )
+        {
+            const uint32 staleSlot = static_cast<uint32>(FMath::CountTrailingZeros64( staleMask ));
+            staleMask &= staleMask - 1;
+
+            ClearSlot( m_Slots.GetSlotAt( staleSlot ).m_Value.m_Key, staleSlot );
+        }
+    }
+
+    return INDEX_NONE;
+}
@@ -0,0 +1,111 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "FrameRingBuffer.h"
+
+/*
+ * Frame-stamped buffer of small integer keys which can be queried and consumed without scanning.
+ * Every key keeps a bitmask of the ring slots holding one of its unconsumed occurrences and the frame it was last pushed on,
+ * so "is the key buffered and unconsumed within N frames" is a mask test plus a frame compare, and consuming is a bit clear.
+ *
+ * Keys can optionally be assigned a rank (0 is the best), occurrences are then also indexed per rank so the best ranked
+ * unconsumed occurrence is found from the lowest non-empty rank bucket.
+ */
+class FIGHTINGGAME_API FConsumableInputBuffer
+{
+public:
+    static constexpr uint32 s_MaxCapacity = 64;
+    static constexpr uint32 s_MaxRanks    = 64;
+    static constexpr int16 s_NoKey        = INDEX_NONE;
+
+    /*
+     * KeyRanks is either empty (every key has rank 0) or holds one rank below s_MaxRanks per key.
+     * The ring always uses every slot: it holds one slot per pushed occurrence, and a frame can push several, so a capacity in frames
+     * would evict occurrences still within the window on bursts
+     */
+    void Init( int32 NumKeys, TConstArrayView<uint8> KeyRanks = TConstArrayView<uint8>() );
+    void Reset();
+
+    /*
+     * Everything pushed so far is treated as consumed, without touching the masks.
+     * Stale bits are dropped lazily the next time a query lands on them.
+     */
+    FORCEINLINE void Invalidate() { ++m_Generation; }
+
+    void Push( int32 Key, uint32 Frame );
+
+    /*
+     * Checks the most recent unconsumed occurrence of Key; older occurrences can't be within the window if the newest isn't
+     */
+    bool Contains( int32 Key, uint32 CurrentFrame, uint32 WindowFrames ) const;
+
+    /*
+     * Consumes the most recent unconsumed occurrence of Key within the window
+     */
+    bool Consume( int32 Key, uint32 CurrentFrame, uint32 WindowFrames );
+
+    void ConsumeAll( int32 Key );
+
+    /*
+     * Key of the most recent unconsumed occurrence within the window from the best non-empty rank, INDEX_NONE if there is none
+     */
+    int32 FindBestRanked( uint32 CurrentFrame, uint32 WindowFrames );
+
+    /*
+     * SlotIndex is a physical ring index, see TFrameRingBuffer::GetSlotAt
+     */
+    FORCEINLINE bool IsConsumed( uint32 SlotIndex ) const
+    {
+        const FEntry& entry = m_Slots.GetSlotAt( SlotIndex ).m_Value;
+        return entry.m_Key == s_NoKey || entry.m_Generation != m_Generation || (m_UnconsumedMasks[entry.m_Key] & (1ull << SlotIndex)) == 0;
+    }
+
+    /*
+     * Visits the occurrences within WindowFrames from the oldest to the newest as ( Key, Frame, IsConsumed )
+     */
+    template<typename FunctionType>
+    void ForEachWithinFrames( uint32 CurrentFrame, uint32 WindowFrames, FunctionType Function ) const
+    {
+        const uint32 capacity = m_Slots.GetCapacity();
+        const uint32 newest   = m_Slots.GetNextIndex() + capacity - 1;
+
+        uint32 count = 0;
+        while( count < m_Slots.Num() && m_Slots.IsWithinFrames( m_Slots.GetSlotAt( newest - count ), CurrentFrame, WindowFrames ) )
+        {
+            ++count;
+        }
+
+        for( int32 i = static_cast<int32>(count) - 1; i >= 0; --i )
+        {
+            const uint32 slotIndex = (newest - i) & (capacity - 1);
+            const auto& slot       = m_Slots.GetSlotAt( slotIndex );
+
+            Function( static_cast<int32>(slot.m_Value.m_Key), slot.m_Frame, IsConsumed( slotIndex ) );
+        }
+    }
+
+private:
+    struct FEntry
+    {
+        int16 m_Key;
+        uint16 m_Generation;
+    };
+
+    TFrameRingBuffer<FEntry, s_MaxCapacity> m_Slots;
+
+    TArray<uint64, TInlineAllocator<16>> m_UnconsumedMasks;
+    TArray<uint32, TInlineAllocator<16>> m_LastFrames;
+
+    TArray<uint8, TInlineAllocator<16>> m_KeyRanks;
+    TArray<uint64, TInlineAllocator<8>> m_RankMasks;
+    uint64 m_NonEmptyRanks = 0;
+
+    uint16 m_Generation = 0;
+
+    int32 FindNewestSlot( uint64 SlotMask ) const;
+    bool IsAlive( int32 SlotIndex, uint32 CurrentFrame, uint32 WindowFrames ) const;
+    void ClearSlot( int32 Key, uint32 SlotIndex );
+};
@@ -0,0 +1,189 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "DirectionalInputQuantizer.h"
+
+#include "Engine/Engine.h"
+#include "FightingGame/Common/MathStatics.h"
+#include "FightingGame/Debugging/Debug.h"
+
+void FDirectionalInputQuantizer::Build( const FDirectionalInputQuantizerSettings& Settings )
+{
+    m_Table.SetNumUninitialized( s_AxisCells * s_AxisCells );
+
+    for( int32 cellY = 0; cellY < s_AxisCells; ++cellY )
+    {
+        for( int32 cellX = 0; cellX < s_AxisCells; ++cellX )
+        {
+            // Each cell is one quantized value, -128 is never produced by QuantizeAxis and is classified like -127
+            const FVector2D stick( FMath::Max( cellX - 128, -127 ) / 127.f, FMath::Max( cellY - 128, -127 ) / 127.f );
+
+            m_Table[(cellY << s_AxisBits) | cellX] = Classify( stick, Settings );
+        }
+    }
+}
+
+void FDirectionalInputQuantizer::QuantizeBatch( TConstArrayView<const FDirectionalInputQuantizer*> Quantizers, TConstArrayView<int8> StickX,
+                                                TConstArrayView<int8> StickY, TArrayView<EInputEntry> OutEntries )
+{
+    const int32 count = Quantizers.Num();
+    check( StickX.Num() == count && StickY.Num() == count && OutEntries.Num() == count );
+
+    for( int32 i = 0; i < count; ++i )
+    {
+        OutEntries[i] = Quantizers[i]->m_Table[GetCellIndex( StickX[i], StickY[i] )];
+    }
+}
+
+float FDirectionalInputQuantizer::GetGateMagnitude( const FVector2D& Stick, EStickGate Gate )
+{
+    const float absX = FMath::Abs( Stick.X );
+    const float absY = FMath::Abs( Stick.Y );
+
+    switch( Gate )
+    {
+        case EStickGate::Square: return FMath::Max( absX, absY );
+        // Regular octagon with its flat sides on the cardinal and diagonal directions
+        case EStickGate::Octagonal: return FMath::Max( FMath::Max( absX, absY ), (absX + absY) * .70710678f );
+        case EStickGate::Circular:
+        default: return Stick.Size();
+    }
+}
+
+EInputEntry FDirectionalInputQuantizer::Classify( const FVector2D& Stick, const FDirectionalInputQuantizerSettings& Settings )
+{
+    const FVector2D stick( FMath::Abs( Stick.X ) > Settings.m_AxisDeadzone ? Stick.X : 0.f,
+                           FMath::Abs( Stick.Y ) > Settings.m_AxisDeadzone ? Stick.Y : 0.f );
+
+    if( GetGateMagnitude( stick, Settings.m_Gate ) <= Settings.m_MinVectorLength )
+    {
+        return EInputEntry::None;
+    }
+
+    return ClassifyAngle( UMathStatics::GetSignedAngle( stick, FVector2D( 0.f, 1.f ) ), Settings.m_RotationEpsilon );
+}
+
+EInputEntry FDirectionalInputQuantizer::ClassifyAngle( float Angle, float RotationEpsilon )
+{
+    static float forwardAngle = 90.f;
+    static float downAngle    = 180.f;
+    static float backAngle    = -90.f;
+    static float upAngle      = 0.f;
+
+    // Up
+    if( Angle > upAngle - RotationEpsilon && Angle < upAngle + RotationEpsilon )
+    {
+        return EInputEntry::Up;
+    }
+
+    // Up-forward
+    if( Angle >= upAngle + RotationEpsilon && Angle < forwardAngle - RotationEpsilon )
+    {
+        return EInputEntry::UpForward;
+    }
+
+    // Forward
+    if( Angle > forwardAngle - RotationEpsilon && Angle < forwardAngle + RotationEpsilon )
+    {
+        return EInputEntry::Forward;
+    }
+
+    // Forward-down
+    if( Angle >= forwardAngle + RotationEpsilon && Angle < downAngle - RotationEpsilon )
+    {
+        return EInputEntry::ForwardDown;
+    }
+
+    // Down
+    if( (Angle >= downAngle && Angle >= downAngle - RotationEpsilon) ||
+        (Angle > -downAngle && Angle < -downAngle + RotationEpsilon) )
+    {
+        return EInputEntry::Down;
+    }
+
+    // Down-back
+    if( Angle > -downAngle + RotationEpsilon && Angle < backAngle - RotationEpsilon )
+    {
+        return EInputEntry::DownBackward;
+    }
+
+    // Back
+    if( Angle > backAngle - RotationEpsilon && Angle < backAngle + RotationEpsilon )
+    {
+        return EInputEntry::Backward;
+    }
+
+    // Back-Up
+    if( Angle >= backAngle + RotationEpsilon && Angle < upAngle - RotationEpsilon )
+    {
+        return EInputEntry::BackwardUp;
+    }
+
+    return EInputEntry::None;
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace
+{
+    /*
+     * Input.BenchmarkDirectionalQuantizer [NumSamples]
+     * Times the table lookup against the GetSignedAngle + angle chain path on the same random stick samples
+     */
+    FAutoConsoleCommand CCmdBenchmarkDirectionalQuantizer(
+        TEXT( "Input.BenchmarkDirectionalQuantizer" ),
+        TEXT( "Times the directional quantizer table against the trigonometric path. Args: [NumSamples]" ),
+        FConsoleCommandWithArgsDelegate::CreateLambda( []( const TArray<FString>& _args )
+        {
+            const int32 numSamples = _args.Num() > 0 ? FMath::Max( FCString::Atoi( *_args[0] ), 1 ) : 1000000;
+
+            FDirectionalInputQuantizerSettings settings;
+
+            FDirectionalInputQuantizer quantizer;
+            quantizer.Build( settings );
+
+            TArray<int8> stickX;
+            TArray<int8> stickY;
+            stickX.SetNumUninitialized( numSamples );
+            stickY.SetNumUninitialized( numSamples );
+
+            FRandomStream random( 1337 );
+            for( int32 i = 0; i < numSamples; ++i )
+            {
+                stickX[i] = static_cast<int8>(random.RandRange( -127, 127 ));
+                stickY[i] = static_cast<int8>(random.RandRange( -127, 127 ));
+            }
+
+            TArray<EInputEntry> trigEntries;
+            TArray<EInputEntry> tableEntries;
+            trigEntries.SetNumUninitialized( numSamples );
+            tableEntries.SetNumUninitialized( numSamples );
+
+            const double trigStart = FPlatformTime::Seconds();
+            for( int32 i = 0; i < numSamples; ++i )
+            {
+                trigEntries[i] = FDirectionalInputQuantizer::Classify( FVector2D( stickX[i] / 127.f, stickY[i] / 127.f ), settings );
+            }
+            const double trigSeconds = FPlatformTime::Seconds() - trigStart;
+
+            const double tableStart = FPlatformTime::Seconds();
+            for( int32 i = 0; i < numSamples; ++i )
+            {
+                tableEntries[i] = quantizer.Quantize( stickX[i], stickY[i] );
+            }
+            const double tableSeconds = FPlatformTime::Seconds() - tableStart;
+
+            // The table is exact for quantized sticks, any mismatch is a bug
+            int32 mismatches = 0;
+            for( int32 i = 0; i < numSamples; ++i )
+            {
+                mismatches += trigEntries[i] != tableEntries[i] ? 1 : 0;
+            }
+
+            FG_SLOG_INFO( FString::Printf(
+                TEXT("Directional quantizer, %d samples: trig %.3f ms (%.2f ns/sample), table %.3f ms (%.2f ns/sample), %d mismatches (%.3f%%)"),
+                numSamples, trigSeconds * 1000.0, trigSeconds * 1e9 / numSamples, tableSeconds * 1000.0, tableSeconds * 1e9 / numSamples,
+                mismatches, 100.0 * mismatches / numSamples ) );
+        } ) );
+}
+
+#endif
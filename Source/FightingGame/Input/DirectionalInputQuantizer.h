@@ -0,0 +1,79 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputEntry.h"
+#include "DirectionalInputQuantizer.generated.h"
+
+/*
+ * Shape of the physical gate around the stick, decides how the stick magnitude is measured against the min length
+ */
+UENUM( BlueprintType )
+enum class EStickGate : uint8
+{
+    Square,
+    Octagonal,
+    Circular,
+};
+
+struct FDirectionalInputQuantizerSettings
+{
+    float m_AxisDeadzone    = .1f;
+    float m_MinVectorLength = .5f;
+    float m_RotationEpsilon = 15.f;
+    EStickGate m_Gate       = EStickGate::Circular;
+};
+
+/*
+ * Maps quantized stick X/Y straight to an EInputEntry through a table built once from the settings.
+ * Each axis is quantized to int8 and the table holds one entry per (X, Y) pair, classified by Classify,
+ * so a lookup is a shift and a load and gives the same entry as Classify for any quantized stick. The table takes 64KB.
+ */
+class FIGHTINGGAME_API FDirectionalInputQuantizer
+{
+public:
+    static constexpr int32 s_AxisBits  = 8;
+    static constexpr int32 s_AxisCells = 1 << s_AxisBits;
+
+    void Build( const FDirectionalInputQuantizerSettings& Settings );
+
+    FORCEINLINE static int8 QuantizeAxis( float Value )
+    {
+        return static_cast<int8>(FMath::RoundToInt( FMath::Clamp( Value, -1.f, 1.f ) * 127.f ));
+    }
+
+    FORCEINLINE static int32 GetCellIndex( int8 X, int8 Y )
+    {
+        const int32 cellX = static_cast<int32>(X) + 128;
+        const int32 cellY = static_cast<int32>(Y) + 128;
+
+        return (cellY << s_AxisBits) | cellX;
+    }
+
+    FORCEINLINE EInputEntry Quantize( int8 X, int8 Y ) const
+    {
+        return m_Table[GetCellIndex( X, Y )];
+    }
+
+    /*
+     * Quantizes one stick per player, Quantizers[i] is used for StickX[i] / StickY[i]
+     */
+    static void QuantizeBatch( TConstArrayView<const FDirectionalInputQuantizer*> Quantizers, TConstArrayView<int8> StickX, TConstArrayView<int8> StickY,
+                               TArrayView<EInputEntry> OutEntries );
+
+    /*
+     * Reference path working on the unquantized vector, the table is built from it
+     */
+    static EInputEntry Classify( const FVector2D& Stick, const FDirectionalInputQuantizerSettings& Settings );
+
+    /*
+     * Angle is measured clockwise from up, in degrees within [-180, 180]
+     */
+    static EInputEntry ClassifyAngle( float Angle, float RotationEpsilon );
+
+    static float GetGateMagnitude( const FVector2D& Stick, EStickGate Gate );
+
+private:
+    TArray<EInputEntry> m_Table;
+};
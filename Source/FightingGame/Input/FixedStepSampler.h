@@ -0,0 +1,80 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Accumulates render time and hands out fixed-duration simulation steps.
+ * The remainder is carried over instead of being discarded, so the step rate does not drift with the render rate;
+ * a single Accumulate can yield several steps (low render rate) or none (high render rate).
+ */
+struct FFixedStepSampler
+{
+    void SetRate( float StepsPerSecond )
+    {
+        ensureMsgf( StepsPerSecond > 0.f, TEXT("Sampler rate must be positive") );
+        m_StepDuration = 1.f / FMath::Max( StepsPerSecond, KINDA_SMALL_NUMBER );
+    }
+
+    void Accumulate( float DeltaTime )
+    {
+        m_Accumulator += DeltaTime;
+
+        if( m_MaxCatchUpSteps > 0 )
+        {
+            // Whole steps past the backlog are dropped, the remainder is kept so the rate itself still doesn't drift
+            const int32 droppedSteps = FMath::FloorToInt( m_Accumulator / m_StepDuration ) - m_MaxCatchUpSteps;
+            if( droppedSteps > 0 )
+            {
+                m_Accumulator -= droppedSteps * m_StepDuration;
+                m_DroppedSteps += droppedSteps;
+            }
+        }
+    }
+
+    bool TryStep()
+    {
+        if( m_Accumulator < m_StepDuration )
+        {
+            return false;
+        }
+
+        m_Accumulator -= m_StepDuration;
+        ++m_Frame;
+
+        return true;
+    }
+
+    void Reset()
+    {
+        m_Accumulator  = 0.f;
+        m_Frame        = 0;
+        m_DroppedSteps = 0;
+    }
+
+    FORCEINLINE uint32 GetFrame() const { return m_Frame; }
+    FORCEINLINE float GetStepDuration() const { return m_StepDuration; }
+
+    /*
+     * Steps skipped because of m_MaxCatchUpSteps since the last Reset, they never produce a frame
+     */
+    FORCEINLINE uint32 GetDroppedSteps() const { return m_DroppedSteps; }
+
+    /*
+     * Fraction of the next step already accumulated, [0, 1)
+     */
+    FORCEINLINE float GetAlpha() const { return m_Accumulator / m_StepDuration; }
+
+    /*
+     * Opt-in cap on the steps a single Accumulate can yield after a hitch, 0 catches up on every step.
+     * Capping drops input frames: frame-counted buffers and timeouts then lag behind real time by the dropped steps.
+     */
+    int32 m_MaxCatchUpSteps = 0;
+
+private:
+    float m_StepDuration  = 1.f / 60.f;
+    float m_Accumulator   = 0.f;
+    uint32 m_Frame        = 0;
+    uint32 m_DroppedSteps = 0;
+};
@@ -0,0 +1,139 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Fixed-capacity ring buffer with inline storage, every slot is stamped with the frame it was pushed on.
+ * The active capacity is rounded up to a power of two (clamped to MaxCapacity) so wrapping is a mask, and pushing never allocates.
+ */
+template<typename ElementType, uint32 MaxCapacity>
+class TFrameRingBuffer
+{
+    static_assert( MaxCapacity > 0 && (MaxCapacity & (MaxCapacity - 1)) == 0, "MaxCapacity must be a power of two" );
+
+public:
+    struct FSlot
+    {
+        ElementType m_Value;
+        uint32 m_Frame;
+    };
+
+    void Init( int32 Capacity, const ElementType& DefaultValue )
+    {
+        m_Capacity = FMath::Min( FMath::RoundUpToPowerOfTwo( static_cast<uint32>(FMath::Max( Capacity, 1 )) ), MaxCapacity );
+        m_Mask     = m_Capacity - 1;
+
+        Reset( DefaultValue );
+    }
+
+    void Reset( const ElementType& DefaultValue )
+    {
+        for( uint32 i = 0; i < m_Capacity; ++i )
+        {
+            m_Slots[i] = FSlot{DefaultValue, 0};
+        }
+
+        m_Head = 0;
+        m_Num  = 0;
+    }
+
+    FSlot& Push( const ElementType& Value, uint32 Frame )
+    {
+        FSlot& slot  = m_Slots[m_Head & m_Mask];
+        slot.m_Value = Value;
+        slot.m_Frame = Frame;
+
+        ++m_Head;
+        m_Num = FMath::Min( m_Num + 1, m_Capacity );
+
+        return slot;
+    }
+
+    FORCEINLINE uint32 Num() const { return m_Num; }
+    FORCEINLINE uint32 GetCapacity() const { return m_Capacity; }
+
+    /*
+     * Physical slot index the next Push will write to; once the buffer is full it is also the oldest slot
+     */
+    FORCEINLINE uint32 GetNextIndex() const { return m_Head & m_Mask; }
+
+    FORCEINLINE FSlot& GetSlotAt( uint32 Index ) { return m_Slots[Index & m_Mask]; }
+    FORCEINLINE const FSlot& GetSlotAt( uint32 Index ) const { return m_Slots[Index & m_Mask]; }
+
+    /*
+     * Index 0 is the most recent entry
+     */
+    FORCEINLINE FSlot& GetFromNewest( uint32 Index )
+    {
+        check( Index < m_Num );
+        return m_Slots[(m_Head - 1 - Index) & m_Mask];
+    }
+
+    FORCEINLINE const FSlot& GetFromNewest( uint32 Index ) const
+    {
+        check( Index < m_Num );
+        return m_Slots[(m_Head - 1 - Index) & m_Mask];
+    }
+
+    FORCEINLINE static bool IsWithinFrames( const FSlot& Slot, uint32 CurrentFrame, uint32 WindowFrames )
+    {
+        return CurrentFrame - Slot.m_Frame < WindowFrames;
+    }
+
+    /*
+     * Walks from the newest entry back and stops at the first one older than WindowFrames
+     */
+    template<typename PredicateType>
+    FSlot* FindNewestWithinFrames( uint32 CurrentFrame, uint32 WindowFrames, PredicateType Predicate )
+    {
+        for( uint32 i = 0; i < m_Num; ++i )
+        {
+            FSlot& slot = GetFromNewest( i );
+            if( !IsWithinFrames( slot, CurrentFrame, WindowFrames ) )
+            {
+                break;
+            }
+
+            if( Predicate( slot ) )
+            {
+                return &slot;
+            }
+        }
+
+        return nullptr;
+    }
+
+    template<typename PredicateType>
+    const FSlot* FindNewestWithinFrames( uint32 CurrentFrame, uint32 WindowFrames, PredicateType Predicate ) const
+    {
+        return const_cast<TFrameRingBuffer*>(this)->FindNewestWithinFrames( CurrentFrame, WindowFrames, Predicate );
+    }
+
+    /*
+     * Visits the entries within WindowFrames from the oldest to the newest
+     */
+    template<typename FunctionType>
+    void ForEachWithinFrames( uint32 CurrentFrame, uint32 WindowFrames, FunctionType Function )
+    {
+        uint32 count = 0;
+        while( count < m_Num && IsWithinFrames( GetFromNewest( count ), CurrentFrame, WindowFrames ) )
+        {
+            ++count;
+        }
+
+        for( int32 i = static_cast<int32>(count) - 1; i >= 0; --i )
+        {
+            Function( GetFromNewest( i ) );
+        }
+    }
+
+private:
+    FSlot m_Slots[MaxCapacity];
+
+    uint32 m_Capacity = 1;
+    uint32 m_Mask     = 0;
+    uint32 m_Head     = 0;
+    uint32 m_Num      = 0;
+};
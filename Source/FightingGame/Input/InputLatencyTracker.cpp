@@ -0,0 +1,299 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "InputLatencyTracker.h"
+
+#include "Engine/Engine.h"
+#include "FightingGame/Debugging/Debug.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_STATS_GROUP( TEXT( "FightingGame Input" ), STATGROUP_FightingGameInput, STATCAT_Advanced );
+
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Inputs Sampled" ), STAT_InputLatency_InputsSampled, STATGROUP_FightingGameInput );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Inputs Consumed" ), STAT_InputLatency_InputsConsumed, STATGROUP_FightingGameInput );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Actions Completed" ), STAT_InputLatency_ActionsCompleted, STATGROUP_FightingGameInput );
+
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Sample p50 (ms)" ), STAT_InputLatency_SampleP50, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Sample p99 (ms)" ), STAT_InputLatency_SampleP99, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Resolve p50 (ms)" ), STAT_InputLatency_ResolveP50, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Resolve p99 (ms)" ), STAT_InputLatency_ResolveP99, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "FSM p50 (ms)" ), STAT_InputLatency_FSMP50, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "FSM p99 (ms)" ), STAT_InputLatency_FSMP99, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Montage p50 (ms)" ), STAT_InputLatency_MontageP50, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Montage p99 (ms)" ), STAT_InputLatency_MontageP99, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Total p50 (ms)" ), STAT_InputLatency_TotalP50, STATGROUP_FightingGameInput );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Total p99 (ms)" ), STAT_InputLatency_TotalP99, STATGROUP_FightingGameInput );
+
+namespace
+{
+#if FG_TRACK_INPUT_LATENCY
+    float loc_CyclesToMs( uint64 From, uint64 To )
+    {
+        return To > From ? static_cast<float>(FPlatformTime::ToMilliseconds64( To - From )) : 0.f;
+    }
+
+    /*
+     * Nearest-rank percentile, sorts Values in place
+     */
+    float loc_Percentile( TArray<float, TInlineAllocator<256>>& Values, float Percentile )
+    {
+        if( Values.IsEmpty() )
+        {
+            return 0.f;
+        }
+
+        Values.Sort();
+
+        const int32 rank = FMath::Clamp( FMath::CeilToInt( Percentile * Values.Num() ) - 1, 0, Values.Num() - 1 );
+        return Values[rank];
+    }
+
+    FAutoConsoleCommand CCmdDumpInputLatencyCsv(
+        TEXT( "Input.DumpLatencyCsv" ),
+        TEXT( "Writes the input latency samples to Saved/Profiling/InputLatency. Args: [FileName]" ),
+        FConsoleCommandWithArgsDelegate::CreateLambda( []( const TArray<FString>& _args )
+        {
+            const FString fileName = _args.Num() > 0 ? _args[0] : FString::Printf( TEXT( "InputLatency_%s" ), *FDateTime::Now().ToString() );
+            const FString filePath = FPaths::ProfilingDir() / TEXT( "InputLatency" ) / fileName + TEXT( ".csv" );
+
+            FInputLatencyStats& stats = FInputLatencyStats::Get();
+            stats.PublishPercentiles();
+
+            if( stats.DumpCsv( filePath ) )
+            {
+                FG_SLOG_INFO( FString::Printf( TEXT( "Input latency samples written to %s" ), *filePath ) );
+            }
+            else
+            {
+                FG_SLOG_ERR( FString::Printf( TEXT( "Could not write input latency samples to %s" ), *filePath ) );
+            }
+        } ) );
+
+    FAutoConsoleCommand CCmdResetInputLatencyStats(
+        TEXT( "Input.ResetLatencyStats" ),
+        TEXT( "Clears the collected input latency samples" ),
+        FConsoleCommandDelegate::CreateLambda( []()
+        {
+            FInputLatencyStats::Get().Reset();
+        } ) );
+#endif
+}
+
+FInputLatencyStats& FInputLatencyStats::Get()
+{
+    static FInputLatencyStats s_Instance;
+    return s_Instance;
+}
+
+void FInputLatencyStats::Submit( const FInputLatencySample& Sample )
+{
+#if FG_TRACK_INPUT_LATENCY
+    if( m_Samples.Num() < s_MaxSamples )
+    {
+        m_Samples.Emplace( Sample );
+    }
+    else
+    {
+        m_Samples[m_NextSample] = Sample;
+    }
+
+    m_NextSample = (m_NextSample + 1) % s_MaxSamples;
+
+    INC_DWORD_STAT( STAT_InputLatency_ActionsCompleted );
+
+    const double now = FPlatformTime::Seconds();
+    if( now - m_LastPublishSeconds >= s_PublishIntervalSeconds )
+    {
+        m_LastPublishSeconds = now;
+        PublishPercentiles();
+    }
+#endif
+}
+
+void FInputLatencyStats::Reset()
+{
+#if FG_TRACK_INPUT_LATENCY
+    m_Samples.Reset();
+    m_NextSample = 0;
+
+    PublishPercentiles();
+#endif
+}
+
+void FInputLatencyStats::PublishPercentiles() const
+{
+#if FG_TRACK_INPUT_LATENCY
+    TArray<float, TInlineAllocator<256>> sample, resolve, fsm, montage, total;
+
+    // Most recent samples only, so the stats follow the current session rather than its whole history
+    const int32 count = FMath::Min( m_Samples.Num(), s_PercentileWindow );
+    for( int32 i = 1; i <= count; ++i )
+    {
+        const FInputLatencySample& latencySample = m_Samples[(m_NextSample - i + s_MaxSamples) % s_MaxSamples];
+
+        sample.Emplace( latencySample.m_SampleMs );
+        resolve.Emplace( latencySample.m_ResolveMs );
+        fsm.Emplace( latencySample.m_FSMMs );
+        total.Emplace( latencySample.m_TotalMs );
+
+        if( latencySample.m_MontageMs >= 0.f )
+        {
+            montage.Emplace( latencySample.m_MontageMs );
+        }
+    }
+
+    SET_FLOAT_STAT( STAT_InputLatency_SampleP50, loc_Percentile( sample, .5f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_SampleP99, loc_Percentile( sample, .99f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_ResolveP50, loc_Percentile( resolve, .5f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_ResolveP99, loc_Percentile( resolve, .99f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_FSMP50, loc_Percentile( fsm, .5f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_FSMP99, loc_Percentile( fsm, .99f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_MontageP50, loc_Percentile( montage, .5f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_MontageP99, loc_Percentile( montage, .99f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_TotalP50, loc_Percentile( total, .5f ) );
+    SET_FLOAT_STAT( STAT_InputLatency_TotalP99, loc_Percentile( total, .99f ) );
+#endif
+}
+
+bool FInputLatencyStats::DumpCsv( const FString& FilePath ) const
+{
+#if FG_TRACK_INPUT_LATENCY
+    FString csv = TEXT( "PlayerIndex,Input,InputFrame,SampleMs,ResolveMs,FSMMs,MontageMs,TotalMs\n" );
+
+    // Oldest first
+    const int32 first = m_Samples.Num() < s_MaxSamples ? 0 : m_NextSample;
+    for( int32 i = 0; i < m_Samples.Num(); ++i )
+    {
+        const FInputLatencySample& sample = m_Samples[(first + i) % m_Samples.Num()];
+
+        csv += FString::Printf( TEXT( "%d,%s,%u,%.3f,%.3f,%.3f,%s,%.3f\n" ), sample.m_PlayerIndex, *InputEntryToString( sample.m_InputEntry ),
+                                sample.m_InputFrame, sample.m_SampleMs, sample.m_ResolveMs, sample.m_FSMMs,
+                                sample.m_MontageMs >= 0.f ? *FString::Printf( TEXT( "%.3f" ), sample.m_MontageMs ) : TEXT( "" ), sample.m_TotalMs );
+    }
+
+    return FFileHelper::SaveStringToFile( csv, *FilePath );
+#else
+    return false;
+#endif
+}
+
+void FInputLatencyTracker::Init( int32 NumInputsSequences )
+{
+    for( FRecord& record : m_InputRecords )
+    {
+        record = FRecord();
+    }
+
+    m_InputsSequenceRecords.Init( FRecord(), NumInputsSequences );
+    m_LastSampled   = FRecord();
+    m_PendingAction = FRecord();
+}
+
+void FInputLatencyTracker::OnInputSampled( EInputEntry InputEntry, uint64 EventCycles, uint32 Frame )
+{
+#if FG_TRACK_INPUT_LATENCY
+    const uint64 now = FPlatformTime::Cycles64();
+
+    FRecord& record       = m_InputRecords[static_cast<int32>(InputEntry)];
+    record                = FRecord();
+    record.m_EventCycles  = EventCycles != 0 ? EventCycles : now;
+    record.m_SampleCycles = now;
+    record.m_Frame        = Frame;
+    record.m_InputEntry   = InputEntry;
+
+    m_LastSampled = record;
+
+    INC_DWORD_STAT( STAT_InputLatency_InputsSampled );
+#endif
+}
+
+void FInputLatencyTracker::OnInputConsumed( EInputEntry InputEntry )
+{
+#if FG_TRACK_INPUT_LATENCY
+    FRecord& record = m_InputRecords[static_cast<int32>(InputEntry)];
+    if( record.IsValid() )
+    {
+        StartAction( record );
+        record = FRecord();
+    }
+#endif
+}
+
+void FInputLatencyTracker::OnInputsSequenceBuffered( int32 InputsSequenceId )
+{
+#if FG_TRACK_INPUT_LATENCY
+    // The sequence completes on the input sampled last
+    if( m_InputsSequenceRecords.IsValidIndex( InputsSequenceId ) )
+    {
+        m_InputsSequenceRecords[InputsSequenceId] = m_LastSampled;
+    }
+#endif
+}
+
+void FInputLatencyTracker::OnInputsSequenceConsumed( int32 InputsSequenceId )
+{
+#if FG_TRACK_INPUT_LATENCY
+    if( m_InputsSequenceRecords.IsValidIndex( InputsSequenceId ) && m_InputsSequenceRecords[InputsSequenceId].IsValid() )
+    {
+        StartAction( m_InputsSequenceRecords[InputsSequenceId] );
+        m_InputsSequenceRecords[InputsSequenceId] = FRecord();
+    }
+#endif
+}
+
+void FInputLatencyTracker::StartAction( const FRecord& Record )
+{
+#if FG_TRACK_INPUT_LATENCY
+    // An action that entered its state but never started a montage is reported without the montage stage
+    if( m_PendingAction.m_StateCycles != 0 )
+    {
+        SubmitAction( 0 );
+    }
+
+    m_PendingAction                 = Record;
+    m_PendingAction.m_ConsumeCycles = FPlatformTime::Cycles64();
+
+    INC_DWORD_STAT( STAT_InputLatency_InputsConsumed );
+#endif
+}
+
+void FInputLatencyTracker::OnStateEntered()
+{
+#if FG_TRACK_INPUT_LATENCY
+    if( m_PendingAction.IsValid() && m_PendingAction.m_StateCycles == 0 )
+    {
+        m_PendingAction.m_StateCycles = FPlatformTime::Cycles64();
+    }
+#endif
+}
+
+void FInputLatencyTracker::OnMontageFirstFrame()
+{
+#if FG_TRACK_INPUT_LATENCY
+    if( m_PendingAction.m_StateCycles != 0 )
+    {
+        SubmitAction( FPlatformTime::Cycles64() );
+    }
+#endif
+}
+
+void FInputLatencyTracker::SubmitAction( uint64 MontageCycles )
+{
+#if FG_TRACK_INPUT_LATENCY
+    const FRecord& record = m_PendingAction;
+
+    FInputLatencySample sample;
+    sample.m_PlayerIndex = m_PlayerIndex;
+    sample.m_InputEntry  = record.m_InputEntry;
+    sample.m_InputFrame  = record.m_Frame;
+    sample.m_SampleMs    = loc_CyclesToMs( record.m_EventCycles, record.m_SampleCycles );
+    sample.m_ResolveMs   = loc_CyclesToMs( record.m_SampleCycles, record.m_ConsumeCycles );
+    sample.m_FSMMs       = loc_CyclesToMs( record.m_ConsumeCycles, record.m_StateCycles );
+    sample.m_MontageMs   = MontageCycles != 0 ? loc_CyclesToMs( record.m_StateCycles, MontageCycles ) : -1.f;
+    sample.m_TotalMs     = loc_CyclesToMs( record.m_EventCycles, MontageCycles != 0 ? MontageCycles : record.m_StateCycles );
+
+    FInputLatencyStats::Get().Submit( sample );
+
+    m_PendingAction = FRecord();
+#endif
+}
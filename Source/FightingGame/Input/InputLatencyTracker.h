@@ -0,0 +1,104 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputEntry.h"
+
+#define FG_TRACK_INPUT_LATENCY (!UE_BUILD_SHIPPING)
+
+/*
+ * One input followed from the moment it entered the moves buffer to the first frame of the montage it started.
+ * Stages are in milliseconds, negative when the action never reached that stage (e.g. a state without a montage).
+ */
+struct FInputLatencySample
+{
+    int32 m_PlayerIndex      = 0;
+    EInputEntry m_InputEntry = EInputEntry::None;
+    uint32 m_InputFrame      = 0;
+
+    float m_SampleMs  = 0.f;
+    float m_ResolveMs = 0.f;
+    float m_FSMMs     = 0.f;
+    float m_MontageMs = -1.f;
+    float m_TotalMs   = 0.f;
+};
+
+/*
+ * Collects the samples of every player, publishes percentiles to STATGROUP_FightingGameInput and dumps them to CSV.
+ * Percentiles sort the recent samples, so they are published at most once per s_PublishIntervalSeconds and when the samples are dumped.
+ * Compiled out with FG_TRACK_INPUT_LATENCY.
+ */
+class FIGHTINGGAME_API FInputLatencyStats
+{
+public:
+    static FInputLatencyStats& Get();
+
+    void Submit( const FInputLatencySample& Sample );
+    void Reset();
+
+    bool DumpCsv( const FString& FilePath ) const;
+
+    void PublishPercentiles() const;
+
+private:
+    static constexpr int32 s_MaxSamples              = 4096;
+    static constexpr int32 s_PercentileWindow        = 256;
+    static constexpr double s_PublishIntervalSeconds = 1.0;
+
+    TArray<FInputLatencySample> m_Samples;
+    int32 m_NextSample = 0;
+
+    double m_LastPublishSeconds = 0.0;
+};
+
+/*
+ * Per-player timestamps of the input pipeline stages: event -> sample -> consume (buffer or sequence) -> state enter -> montage.
+ * Only the most recent occurrence of every input entry and sequence is followed.
+ */
+class FIGHTINGGAME_API FInputLatencyTracker
+{
+public:
+    void Init( int32 NumInputsSequences );
+
+    /*
+     * Player indices are assigned after BeginPlay, so the owner keeps this up to date
+     */
+    FORCEINLINE void SetPlayerIndex( int32 PlayerIndex ) { m_PlayerIndex = PlayerIndex; }
+
+    /*
+     * EventCycles is 0 when the input was produced by the sampling itself (stick, playback, bots)
+     */
+    void OnInputSampled( EInputEntry InputEntry, uint64 EventCycles, uint32 Frame );
+    void OnInputConsumed( EInputEntry InputEntry );
+
+    void OnInputsSequenceBuffered( int32 InputsSequenceId );
+    void OnInputsSequenceConsumed( int32 InputsSequenceId );
+
+    void OnStateEntered();
+    void OnMontageFirstFrame();
+
+private:
+    struct FRecord
+    {
+        uint64 m_EventCycles     = 0;
+        uint64 m_SampleCycles    = 0;
+        uint64 m_ConsumeCycles   = 0;
+        uint64 m_StateCycles     = 0;
+        uint32 m_Frame           = 0;
+        EInputEntry m_InputEntry = EInputEntry::None;
+
+        FORCEINLINE bool IsValid() const { return m_SampleCycles != 0; }
+    };
+
+    int32 m_PlayerIndex = 0;
+
+    FRecord m_InputRecords[static_cast<int32>(EInputEntry::COUNT)];
+    TArray<FRecord> m_InputsSequenceRecords;
+    FRecord m_LastSampled;
+
+    FRecord m_PendingAction;
+
+    void StartAction( const FRecord& Record );
+    void SubmitAction( uint64 MontageCycles );
+};
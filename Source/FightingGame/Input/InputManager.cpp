@@ -0,0 +1,176 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "InputManager.h"
+
+#include "EngineUtils.h"
+#include "MovesBufferComponent.h"
+#include "FightingGame/Character/FightingCharacter.h"
+#include "FightingGame/Debugging/Debug.h"
+
+AInputManager::AInputManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	m_Players.SetNum( s_MaxPlayers );
+	m_InputsBuffers.SetNum( s_MaxPlayers );
+	m_InputsSequenceBuffers.SetNum( s_MaxPlayers );
+}
+
+void AInputManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	m_InputSampler.SetRate( m_InputSampleRate );
+}
+
+void AInputManager::OnRegister( AGameFramework& Framework )
+{
+	Super::OnRegister( Framework );
+
+	// Characters that began play before the manager existed are ticking on their own
+	for( TActorIterator<AFightingCharacter> it( GetWorld() ); it; ++it )
+	{
+		if( UMovesBufferComponent* movesBuffer = it->GetMovesBufferComponent() )
+		{
+			if( movesBuffer->HasBegunPlay() )
+			{
+				movesBuffer->RegisterToInputManager( this );
+			}
+		}
+	}
+}
+
+void AInputManager::OnDeregister( AGameFramework& Framework )
+{
+	for( TObjectPtr<UMovesBufferComponent>& player : m_Players )
+	{
+		if( player )
+		{
+			player->UnregisterFromInputManager();
+		}
+	}
+
+	Super::OnDeregister( Framework );
+}
+
+int32 AInputManager::RegisterPlayer( UMovesBufferComponent* MovesBuffer )
+{
+	const int32 slot = m_Players.IndexOfByKey( nullptr );
+	if( slot == INDEX_NONE )
+	{
+		FG_SLOG_WARN( FString::Printf( TEXT("Input manager has no free slot for [%s], it will tick on its own"), *GetNameSafe( MovesBuffer->GetOwner() ) ) );
+		return INDEX_NONE;
+	}
+
+	m_Players[slot] = MovesBuffer;
+
+	// The owner reads the buffers from its own tick, it has to run after the pass
+	AActor* owner = MovesBuffer->GetOwner();
+	owner->AddTickPrerequisiteActor( this );
+
+	TInlineComponentArray<UActorComponent*> components( owner );
+	for( UActorComponent* component : components )
+	{
+		if( component != MovesBuffer )
+		{
+			component->AddTickPrerequisiteActor( this );
+		}
+	}
+
+	BuildPassOrder();
+
+	return slot;
+}
+
+void AInputManager::UnregisterPlayer( int32 Slot )
+{
+	if( !m_Players.IsValidIndex( Slot ) || !m_Players[Slot] )
+	{
+		return;
+	}
+
+	if( AActor* owner = m_Players[Slot]->GetOwner() )
+	{
+		owner->RemoveTickPrerequisiteActor( this );
+
+		TInlineComponentArray<UActorComponent*> components( owner );
+		for( UActorComponent* component : components )
+		{
+			component->RemoveTickPrerequisiteActor( this );
+		}
+	}
+
+	m_Players[Slot] = nullptr;
+	m_InputsBuffers[Slot].Reset();
+	m_InputsSequenceBuffers[Slot].Reset();
+
+	BuildPassOrder();
+}
+
+void AInputManager::OnPlayerIndexChanged()
+{
+	BuildPassOrder();
+}
+
+void AInputManager::Tick( float DeltaTime )
+{
+	Super::Tick( DeltaTime );
+
+	m_InputSampler.Accumulate( DeltaTime );
+	while( m_InputSampler.TryStep() )
+	{
+		SampleInputFrame();
+	}
+
+	for( int32 slot : m_PassOrder )
+	{
+		m_Players[slot]->UpdateDebugDisplay();
+	}
+}
+
+void AInputManager::BuildPassOrder()
+{
+	m_PassOrder.Reset();
+
+	for( int32 slot = 0; slot < m_Players.Num(); ++slot )
+	{
+		if( m_Players[slot] )
+		{
+			m_PassOrder.Emplace( slot );
+		}
+	}
+
+	m_PassOrder.StableSort( [this]( int32 A, int32 B )
+	{
+		return m_Players[A]->GetPlayerIndex() < m_Players[B]->GetPlayerIndex();
+	} );
+}
+
+void AInputManager::SampleInputFrame()
+{
+	const int32 numPlayers = m_PassOrder.Num();
+
+	m_RawFrames.SetNum( numPlayers );
+	m_StickX.SetNum( numPlayers );
+	m_StickY.SetNum( numPlayers );
+	m_Quantizers.SetNum( numPlayers );
+	m_DirectionalEntries.SetNum( numPlayers );
+
+	for( int32 i = 0; i < numPlayers; ++i )
+	{
+		UMovesBufferComponent* player = m_Players[m_PassOrder[i]];
+
+		m_RawFrames[i]  = player->CollectRawInputFrame();
+		m_StickX[i]     = m_RawFrames[i].m_StickX;
+		m_StickY[i]     = m_RawFrames[i].m_StickY;
+		m_Quantizers[i] = &player->GetDirectionalQuantizer();
+	}
+
+	FDirectionalInputQuantizer::QuantizeBatch( m_Quantizers, m_StickX, m_StickY, m_DirectionalEntries );
+
+	// Buffering and resolving can trigger gameplay callbacks, keep them in player order
+	for( int32 i = 0; i < numPlayers; ++i )
+	{
+		m_Players[m_PassOrder[i]]->ProcessRawInputFrame( m_RawFrames[i], m_DirectionalEntries[i] );
+	}
+}
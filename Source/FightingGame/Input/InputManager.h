@@ -0,0 +1,80 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ConsumableInputBuffer.h"
+#include "DirectionalInputQuantizer.h"
+#include "FixedStepSampler.h"
+#include "RawInputFrame.h"
+#include "FightingGame/Common/Manager.h"
+#include "InputManager.generated.h"
+
+class UMovesBufferComponent;
+
+/*
+ * Samples, quantizes, buffers and resolves the inputs of every player in a single ordered pass per input frame.
+ * Per-player data is stored here in arrays indexed by slot, the moves buffer components are views over their slot.
+ * Components that can't find an input manager keep ticking on their own.
+ */
+UCLASS()
+class FIGHTINGGAME_API AInputManager : public AManager
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 s_MaxPlayers = 8;
+
+	AInputManager();
+
+	virtual void OnRegister( AGameFramework& Framework ) override;
+	virtual void OnDeregister( AGameFramework& Framework ) override;
+
+	/*
+	 * Returns the slot assigned to the moves buffer, INDEX_NONE if every slot is taken
+	 */
+	int32 RegisterPlayer( UMovesBufferComponent* MovesBuffer );
+	void UnregisterPlayer( int32 Slot );
+
+	/*
+	 * Player indices are assigned after the characters begin play, the pass order is rebuilt when one changes
+	 */
+	void OnPlayerIndexChanged();
+
+	FORCEINLINE FFixedStepSampler& GetInputSampler() { return m_InputSampler; }
+	FORCEINLINE FConsumableInputBuffer& GetInputsBuffer( int32 Slot ) { return m_InputsBuffers[Slot]; }
+	FORCEINLINE FConsumableInputBuffer& GetInputsSequenceBuffer( int32 Slot ) { return m_InputsSequenceBuffers[Slot]; }
+
+protected:
+	/*
+	 * Shared by every player so all the buffers are stamped with the same input frames
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Input Sample Rate (FPS)", meta = (ClampMin = "1") )
+	float m_InputSampleRate = 60.f;
+
+	virtual void BeginPlay() override;
+
+public:
+	virtual void Tick( float DeltaTime ) override;
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<UMovesBufferComponent>> m_Players;
+
+	FFixedStepSampler m_InputSampler;
+
+	// Indexed by slot, fixed storage so the moves buffers can keep pointers to their own buffers
+	TArray<FConsumableInputBuffer, TFixedAllocator<s_MaxPlayers>> m_InputsBuffers;
+	TArray<FConsumableInputBuffer, TFixedAllocator<s_MaxPlayers>> m_InputsSequenceBuffers;
+
+	// Indexed by pass position, slots are processed by ascending player index
+	TArray<int32, TFixedAllocator<s_MaxPlayers>> m_PassOrder;
+	TArray<FRawInputFrame, TFixedAllocator<s_MaxPlayers>> m_RawFrames;
+	TArray<int8, TFixedAllocator<s_MaxPlayers>> m_StickX;
+	TArray<int8, TFixedAllocator<s_MaxPlayers>> m_StickY;
+	TArray<const FDirectionalInputQuantizer*, TFixedAllocator<s_MaxPlayers>> m_Quantizers;
+	TArray<EInputEntry, TFixedAllocator<s_MaxPlayers>> m_DirectionalEntries;
+
+	void BuildPassOrder();
+	void SampleInputFrame();
+};
@@ -0,0 +1,240 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "InputRecording.h"
+
+#include "Algo/BinarySearch.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    constexpr uint32 loc_InlineRunLengthMax = 15;
+}
+
+void FInputRecording::Reset( float SampleRate )
+{
+    m_Data.Reset();
+    m_Keyframes.Reset();
+    m_NumFrames  = 0;
+    m_SampleRate = SampleRate;
+
+    m_RunFrame         = FRawInputFrame();
+    m_PreviousRunFrame = FRawInputFrame();
+    m_RunStartFrame    = 0;
+    m_RunLength        = 0;
+}
+
+void FInputRecording::Append( const FRawInputFrame& Frame )
+{
+    const bool isKeyframe = m_NumFrames % s_KeyframeInterval == 0;
+    if( m_RunLength > 0 && Frame == m_RunFrame && !isKeyframe )
+    {
+        ++m_RunLength;
+    }
+    else
+    {
+        FlushRun();
+
+        m_RunFrame      = Frame;
+        m_RunStartFrame = m_NumFrames;
+        m_RunLength     = 1;
+    }
+
+    ++m_NumFrames;
+}
+
+void FInputRecording::Finish()
+{
+    FlushRun();
+}
+
+void FInputRecording::FlushRun()
+{
+    if( m_RunLength == 0 )
+    {
+        return;
+    }
+
+    uint8 fieldMask = EFieldMask::All;
+    if( m_RunStartFrame % s_KeyframeInterval == 0 )
+    {
+        m_Keyframes.Emplace( FInputRecordingKeyframe{m_RunStartFrame, static_cast<uint32>(m_Data.Num())} );
+    }
+    else
+    {
+        fieldMask = static_cast<uint8>((m_RunFrame.m_Held != m_PreviousRunFrame.m_Held ? EFieldMask::Held : 0) |
+                                       (m_RunFrame.m_Edges != m_PreviousRunFrame.m_Edges ? EFieldMask::Edges : 0) |
+                                       (m_RunFrame.m_StickX != m_PreviousRunFrame.m_StickX ? EFieldMask::StickX : 0) |
+                                       (m_RunFrame.m_StickY != m_PreviousRunFrame.m_StickY ? EFieldMask::StickY : 0));
+    }
+
+    const uint32 runLengthMinusOne = m_RunLength - 1;
+    m_Data.Emplace( static_cast<uint8>(fieldMask | (FMath::Min( runLengthMinusOne, loc_InlineRunLengthMax ) << 4)) );
+
+    if( runLengthMinusOne >= loc_InlineRunLengthMax )
+    {
+        uint32 remaining = runLengthMinusOne - loc_InlineRunLengthMax;
+        do
+        {
+            const uint8 byte = remaining & 0x7F;
+            remaining >>= 7;
+
+            m_Data.Emplace( static_cast<uint8>(byte | (remaining != 0 ? 0x80 : 0)) );
+        }
+        while( remaining != 0 );
+    }
+
+    if( fieldMask & EFieldMask::Held ) { m_Data.Emplace( m_RunFrame.m_Held ); }
+    if( fieldMask & EFieldMask::Edges ) { m_Data.Emplace( m_RunFrame.m_Edges ); }
+    if( fieldMask & EFieldMask::StickX ) { m_Data.Emplace( static_cast<uint8>(m_RunFrame.m_StickX) ); }
+    if( fieldMask & EFieldMask::StickY ) { m_Data.Emplace( static_cast<uint8>(m_RunFrame.m_StickY) ); }
+
+    m_PreviousRunFrame = m_RunFrame;
+    m_RunLength        = 0;
+}
+
+void FInputRecording::Serialize( FArchive& Ar )
+{
+    uint32 magic   = s_Magic;
+    uint32 version = s_Version;
+    Ar << magic << version;
+
+    if( Ar.IsLoading() && (magic != s_Magic || version != s_Version) )
+    {
+        Ar.SetError();
+        return;
+    }
+
+    Ar << m_SampleRate << m_NumFrames << m_Keyframes << m_Data;
+}
+
+bool FInputRecording::SaveToFile( const FString& FilePath )
+{
+    Finish();
+
+    TArray<uint8> bytes;
+    FMemoryWriter writer( bytes );
+    Serialize( writer );
+
+    return FFileHelper::SaveArrayToFile( bytes, *FilePath );
+}
+
+bool FInputRecording::LoadFromFile( const FString& FilePath )
+{
+    TArray<uint8> bytes;
+    if( !FFileHelper::LoadFileToArray( bytes, *FilePath ) )
+    {
+        return false;
+    }
+
+    FMemoryReader reader( bytes );
+    Serialize( reader );
+
+    return !reader.IsError();
+}
+
+FString FInputRecording::GetRecordingFilePath( const FString& RecordingName, int32 PlayerIndex )
+{
+    return FPaths::ProjectSavedDir() / TEXT( "InputRecordings" ) / FString::Printf( TEXT( "%s_P%d.fgir" ), *RecordingName, PlayerIndex );
+}
+
+FInputRecording::FReader::FReader( const FInputRecording& Recording, uint32 StartFrame )
+    : m_Recording( Recording )
+{
+    const TArray<FInputRecordingKeyframe>& keyframes = Recording.m_Keyframes;
+    if( keyframes.IsEmpty() )
+    {
+        m_Offset = Recording.m_Data.Num();
+        return;
+    }
+
+    // Last keyframe at or before the start frame, then decode forward from it
+    const int32 keyframeIndex = FMath::Max( Algo::UpperBoundBy( keyframes, StartFrame, &FInputRecordingKeyframe::m_Frame ) - 1, 0 );
+
+    m_Offset = keyframes[keyframeIndex].m_Offset;
+    m_Frame  = keyframes[keyframeIndex].m_Frame;
+
+    FRawInputFrame skipped;
+    while( m_Frame < StartFrame && Next( skipped ) )
+    {
+    }
+}
+
+bool FInputRecording::FReader::ReadRun()
+{
+    const TArray<uint8>& data = m_Recording.m_Data;
+    if( m_Offset >= static_cast<uint32>(data.Num()) )
+    {
+        return false;
+    }
+
+    const uint8 header    = data[m_Offset++];
+    const uint8 fieldMask = header & 0x0F;
+    uint32 runLength      = (header >> 4) + 1;
+
+    if( runLength > loc_InlineRunLengthMax )
+    {
+        uint32 shift = 0;
+        uint8 byte   = 0;
+        do
+        {
+            if( m_Offset >= static_cast<uint32>(data.Num()) )
+            {
+                return false;
+            }
+
+            byte = data[m_Offset++];
+            runLength += static_cast<uint32>(byte & 0x7F) << shift;
+            shift += 7;
+        }
+        while( byte & 0x80 );
+    }
+
+    const int32 numFields = FMath::CountBits( fieldMask );
+    if( m_Offset + numFields > static_cast<uint32>(data.Num()) )
+    {
+        return false;
+    }
+
+    if( fieldMask & EFieldMask::Held ) { m_Current.m_Held = data[m_Offset++]; }
+    if( fieldMask & EFieldMask::Edges ) { m_Current.m_Edges = data[m_Offset++]; }
+    if( fieldMask & EFieldMask::StickX ) { m_Current.m_StickX = static_cast<int8>(data[m_Offset++]); }
+    if( fieldMask & EFieldMask::StickY ) { m_Current.m_StickY = static_cast<int8>(data[m_Offset++]); }
+
+    m_RunRemaining = runLength;
+
+    return true;
+}
+
+bool FInputRecording::FReader::Next( FRawInputFrame& OutFrame )
+{
+    if( m_Frame >= m_Recording.m_NumFrames )
+    {
+        return false;
+    }
+
+    if( m_RunRemaining == 0 && !ReadRun() )
+    {
+        return false;
+    }
+
+    OutFrame = m_Current;
+
+    --m_RunRemaining;
+    ++m_Frame;
+
+    return true;
+}
+
+FInputPlaybackSource::FInputPlaybackSource( TSharedRef<FInputRecording> Recording, uint32 StartFrame )
+    : m_Recording( Recording )
+    , m_Reader( Recording.Get(), StartFrame )
+{
+}
+
+bool FInputPlaybackSource::PollFrame( FRawInputFrame& OutFrame )
+{
+    return m_Reader.Next( OutFrame );
+}
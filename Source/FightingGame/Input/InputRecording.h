@@ -0,0 +1,110 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RawInputFrame.h"
+
+struct FInputRecordingKeyframe
+{
+    uint32 m_Frame  = 0;
+    uint32 m_Offset = 0;
+
+    friend FArchive& operator<<( FArchive& Ar, FInputRecordingKeyframe& Keyframe )
+    {
+        return Ar << Keyframe.m_Frame << Keyframe.m_Offset;
+    }
+};
+
+/*
+ * Raw input frames of one player, stored as runs of identical frames.
+ * Every run starts with a header byte: the low 4 bits flag which fields changed from the previous run, the high 4 bits hold
+ * the run length minus one, 15 meaning a varint with the rest of the length follows. Only the changed fields are written after it.
+ * A run is forced every s_KeyframeInterval frames with every field written, and indexed, so reading can start from any frame.
+ */
+class FIGHTINGGAME_API FInputRecording
+{
+public:
+    static constexpr uint32 s_KeyframeInterval = 256;
+
+    void Reset( float SampleRate );
+
+    void Append( const FRawInputFrame& Frame );
+
+    /*
+     * Writes the pending run, call once recording is over
+     */
+    void Finish();
+
+    FORCEINLINE uint32 GetNumFrames() const { return m_NumFrames; }
+    FORCEINLINE float GetSampleRate() const { return m_SampleRate; }
+    FORCEINLINE int32 GetEncodedSize() const { return m_Data.Num(); }
+
+    void Serialize( FArchive& Ar );
+
+    bool SaveToFile( const FString& FilePath );
+    bool LoadFromFile( const FString& FilePath );
+
+    static FString GetRecordingFilePath( const FString& RecordingName, int32 PlayerIndex );
+
+    class FIGHTINGGAME_API FReader
+    {
+    public:
+        FReader( const FInputRecording& Recording, uint32 StartFrame );
+
+        bool Next( FRawInputFrame& OutFrame );
+
+        FORCEINLINE uint32 GetFrame() const { return m_Frame; }
+
+    private:
+        const FInputRecording& m_Recording;
+
+        FRawInputFrame m_Current;
+        uint32 m_Offset       = 0;
+        uint32 m_RunRemaining = 0;
+        uint32 m_Frame        = 0;
+
+        bool ReadRun();
+    };
+
+private:
+    static constexpr uint32 s_Magic   = 0x52494746; // "FGIR"
+    static constexpr uint32 s_Version = 2;
+
+    enum EFieldMask : uint8
+    {
+        Held   = 1 << 0,
+        Edges  = 1 << 1,
+        StickX = 1 << 2,
+        StickY = 1 << 3,
+        All    = Held | Edges | StickX | StickY,
+    };
+
+    TArray<uint8> m_Data;
+    TArray<FInputRecordingKeyframe> m_Keyframes;
+    uint32 m_NumFrames = 0;
+    float m_SampleRate = 60.f;
+
+    FRawInputFrame m_RunFrame;
+    FRawInputFrame m_PreviousRunFrame;
+    uint32 m_RunStartFrame = 0;
+    uint32 m_RunLength     = 0;
+
+    void FlushRun();
+};
+
+/*
+ * Feeds a moves buffer from a recording, starting from any frame
+ */
+class FIGHTINGGAME_API FInputPlaybackSource : public IInputFrameSource
+{
+public:
+    FInputPlaybackSource( TSharedRef<FInputRecording> Recording, uint32 StartFrame );
+
+    virtual bool PollFrame( FRawInputFrame& OutFrame ) override;
+
+private:
+    TSharedRef<FInputRecording> m_Recording;
+    FInputRecording::FReader m_Reader;
+};
@@ -4,8 +4,10 @@
 #include "Components/InputComponent.h"
 #include "FightingGame/Character/FightingCharacter.h"
 #include "FightingGame/Combat/InputSequenceResolver.h"
-#include "FightingGame/Common/MathStatics.h"
 #include "FightingGame/Debugging/Debug.h"
+#include "FightingGame/Common/GameFramework.h"
+#include "InputManager.h"
+#include "InputRecording.h"
 #include "Kismet/KismetSystemLibrary.h"
 
 namespace
@@ -18,6 +20,24 @@ namespace
 
     int32 loc_ShowDirectionalAngle = 0;
     FG_CVAR_FLAG_DESC( CVarShowDirectionalAngle, TEXT("MovesBufferComponent.ShowDirectionalAngle"), loc_ShowDirectionalAngle );
+
+    struct FButtonBinding
+    {
+        const TCHAR* m_ActionName;
+        ERawInputButton m_Button;
+        EInputEntry m_PressedEntry;
+        EInputEntry m_ReleasedEntry;
+    };
+
+    // In buffering order, an entry of None doesn't reach the buffer
+    const FButtonBinding loc_ButtonBindings[] =
+    {
+        { TEXT( "Jump" ), ERawInputButton::Jump, EInputEntry::StartJump, EInputEntry::StopJump },
+        { TEXT( "Attack" ), ERawInputButton::Attack, EInputEntry::Attack, EInputEntry::None },
+        { TEXT( "Special" ), ERawInputButton::Special, EInputEntry::Special, EInputEntry::None },
+    };
+
+    static_assert( UE_ARRAY_COUNT( loc_ButtonBindings ) == static_cast<int32>(ERawInputButton::COUNT), "Every raw input button needs a binding" );
 }
 
 UMovesBufferComponent::UMovesBufferComponent()
@@ -35,62 +55,215 @@ void UMovesBufferComponent::BeginPlay()
 
     m_InputSequenceResolver->m_InputRouteEndedDelegate.AddUObject( this, &UMovesBufferComponent::OnInputRouteEnded );
 
-    TArray<TObjectPtr<UInputsSequence>> inputs;
-    TArray<TTuple<bool, bool>> groundedAirborneFlags;
-    for( int32 i = 0; i < m_InputsList.Num(); ++i )
+    m_InputSequenceResolver->Init( m_InputsList );
+    m_InputSequenceResolver->SetStanceFilters( m_InputsList, BuildGroundedAirborneFlags() );
+
+    m_LocalInputSampler.SetRate( m_InputSampleRate );
+
+    BuildDirectionalQuantizer();
+
+    BuildInputsSequenceRegistry();
+    InitInputsSequenceBuffer();
+
+    m_LatencyTracker.Init( m_InputsList.Num() );
+
+    if( AInputManager* inputManager = AGameFramework::FindWorldManager<AInputManager>( GetWorld() ) )
+    {
+        RegisterToInputManager( inputManager );
+    }
+}
+
+void UMovesBufferComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+    UnregisterFromInputManager();
+
+    Super::EndPlay( EndPlayReason );
+}
+
+void UMovesBufferComponent::RegisterToInputManager( AInputManager* InputManager )
+{
+    if( m_InputManager || !InputManager )
     {
-        inputs.Emplace( m_InputsList[i] );
+        return;
+    }
 
-        // #TODO find a way to link these inputs to the actual moves
-        groundedAirborneFlags.Emplace( TTuple<bool, bool>( true, true ) );
+    const int32 slot = InputManager->RegisterPlayer( this );
+    if( slot == INDEX_NONE )
+    {
+        return;
     }
 
-    m_InputSequenceResolver->Init( inputs, groundedAirborneFlags );
+    m_InputManager         = InputManager;
+    m_InputSlot            = slot;
+    m_InputSampler         = &InputManager->GetInputSampler();
+    m_InputsBuffer         = &InputManager->GetInputsBuffer( slot );
+    m_InputsSequenceBuffer = &InputManager->GetInputsSequenceBuffer( slot );
+
+    // Frames buffered so far were stamped by the local sampler
+    InitInputBuffer();
+    InitInputsSequenceBuffer();
+
+    SetComponentTickEnabled( false );
 }
 
-void UMovesBufferComponent::TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction )
+void UMovesBufferComponent::UnregisterFromInputManager()
 {
-    Super::TickComponent( DeltaTime, TickType, ThisTickFunction );
+    if( !m_InputManager )
+    {
+        return;
+    }
+
+    m_InputManager->UnregisterPlayer( m_InputSlot );
+
+    m_InputManager         = nullptr;
+    m_InputSlot            = INDEX_NONE;
+    m_InputSampler         = &m_LocalInputSampler;
+    m_InputsBuffer         = &m_LocalInputsBuffer;
+    m_InputsSequenceBuffer = &m_LocalInputsSequenceBuffer;
+
+    InitInputBuffer();
+    InitInputsSequenceBuffer();
+
+    SetComponentTickEnabled( true );
+}
+
+void UMovesBufferComponent::RegisterMove( UMoveDataAsset* Move )
+{
+    if( Move && Move->m_InputsSequence && !m_Moves.Contains( Move ) )
+    {
+        m_Moves.Emplace( Move );
+
+        // Moves registered before BeginPlay are applied once the resolver exists, the matching progress is kept
+        if( m_InputSequenceResolver )
+        {
+            m_InputSequenceResolver->SetStanceFilters( m_InputsList, BuildGroundedAirborneFlags() );
+        }
+    }
+}
+
+TArray<TTuple<bool, bool>> UMovesBufferComponent::BuildGroundedAirborneFlags() const
+{
+    // Sequences that no move uses keep matching in both stances
+    TArray<TTuple<bool, bool>> groundedAirborneFlags;
+    groundedAirborneFlags.Init( TTuple<bool, bool>( true, true ), m_InputsList.Num() );
 
-    m_IBElapsedFrameTime += DeltaTime;
+    TBitArray<> linkedSequences( false, m_InputsList.Num() );
 
-    static float bufferFrameDuration = 1.f / m_InputBufferFrameRate;
-    if( m_IBElapsedFrameTime >= bufferFrameDuration )
+    for( const TObjectPtr<UMoveDataAsset>& move : m_Moves )
     {
-        m_IBElapsedFrameTime = 0.f;
+        if( !move || !move->m_InputsSequence )
+        {
+            continue;
+        }
 
-        if( !m_IBBufferChanged )
+        const int32 inputsSequenceIdx = m_InputsList.IndexOfByKey( move->m_InputsSequence );
+        if( inputsSequenceIdx == INDEX_NONE )
         {
-            AddToInputBuffer( EInputEntry::None );
+            FG_SLOG_WARN( FString::Printf( TEXT("Move [%s] uses inputs sequence [%s] which is not in the inputs list"), *move->m_Id.ToString(),
+                                           *move->m_InputsSequence->m_Name.ToString() ) );
+            continue;
         }
+
+        // A sequence shared by several moves is allowed wherever one of them is
+        TTuple<bool, bool>& flags = groundedAirborneFlags[inputsSequenceIdx];
+        if( !linkedSequences[inputsSequenceIdx] )
+        {
+            flags = TTuple<bool, bool>( false, false );
+            linkedSequences[inputsSequenceIdx] = true;
+        }
+
+        flags.Key   |= move->m_AllowWhenGrounded;
+        flags.Value |= move->m_AllowWhenAirborne;
+    }
+
+    return groundedAirborneFlags;
+}
+
+void UMovesBufferComponent::BuildInputsSequenceRegistry()
+{
+    m_InputsSequenceIds.Reset();
+    m_InputsSequenceRanks.Reset();
+
+    // Ranks are the dense order of the distinct priorities, so the buffer can bucket sequences by priority
+    TArray<int32, TInlineAllocator<16>> priorities;
+    for( const TObjectPtr<UInputsSequence>& inputsSequence : m_InputsList )
+    {
+        priorities.AddUnique( inputsSequence ? inputsSequence->m_Priority : MAX_int32 );
     }
 
-    m_ISBElapsedFrameTime += DeltaTime;
+    priorities.Sort();
 
-    static float movesBufferFrameDuration = 1.f / m_InputsSequencesBufferFrameRate;
-    if( m_ISBElapsedFrameTime >= movesBufferFrameDuration )
+    constexpr int32 maxRank = static_cast<int32>(FConsumableInputBuffer::s_MaxRanks) - 1;
+    ensureMsgf( priorities.Num() - 1 <= maxRank, TEXT("%d distinct inputs sequence priorities, the ones past %d share the last rank"), priorities.Num(), maxRank );
+
+    for( int32 i = 0; i < m_InputsList.Num(); ++i )
     {
-        m_ISBElapsedFrameTime = 0.f;
-        if( !m_ISBBufferChanged )
+        const TObjectPtr<UInputsSequence>& inputsSequence = m_InputsList[i];
+        const int32 priority                               = inputsSequence ? inputsSequence->m_Priority : MAX_int32;
+
+        m_InputsSequenceRanks.Emplace( static_cast<uint8>(FMath::Min( priorities.IndexOfByKey( priority ), maxRank )) );
+
+        if( !inputsSequence )
         {
-            AddToInputsSequenceBuffer( FInputsSequenceBufferEntry::s_SequenceNone, 0 );
+            continue;
         }
+
+        if( m_InputsSequenceIds.Contains( inputsSequence->m_Name ) )
+        {
+            FG_SLOG_WARN( FString::Printf( TEXT("Duplicated inputs sequence name %s, only the first one can be looked up by name"), *inputsSequence->m_Name.ToString() ) );
+            continue;
+        }
+
+        m_InputsSequenceIds.Emplace( inputsSequence->m_Name, i );
+    }
+}
+
+void UMovesBufferComponent::TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction )
+{
+    Super::TickComponent( DeltaTime, TickType, ThisTickFunction );
+
+    // Only ticking when no input manager drives this component
+    m_InputSampler->Accumulate( DeltaTime );
+    while( m_InputSampler->TryStep() )
+    {
+        const FRawInputFrame rawFrame = CollectRawInputFrame();
+        ProcessRawInputFrame( rawFrame, m_DirectionalQuantizer.Quantize( rawFrame.m_StickX, rawFrame.m_StickY ) );
+    }
+
+    UpdateDebugDisplay();
+}
+
+int32 UMovesBufferComponent::GetPlayerIndex() const
+{
+    return m_OwnerCharacter ? m_OwnerCharacter->m_PlayerIndex : 0;
+}
+
+void UMovesBufferComponent::OnPlayerIndexChanged()
+{
+    m_LatencyTracker.SetPlayerIndex( GetPlayerIndex() );
+
+    if( m_InputManager )
+    {
+        m_InputManager->OnPlayerIndexChanged();
     }
+}
+
+void UMovesBufferComponent::UpdateDebugDisplay()
+{
+    const uint32 currentFrame = m_InputSampler->GetFrame();
 
     if( loc_ShowInputBuffer )
     {
         if( m_OwnerCharacter && m_OwnerCharacter->m_PlayerIndex == 0 )
         {
-            for( int32 i = 0; i < m_InputsBuffer.size(); ++i )
+            int32 messageKey = 0;
+            m_InputsBuffer->ForEachWithinFrames( currentFrame, m_InputBufferSizeFrames, [&]( int32 _key, uint32 _frame, bool _consumed )
             {
-                FInputBufferEntry& entry = m_InputsBuffer.at( i );
-                const bool isEmpty       = entry.m_InputEntry == EInputEntry::None;
-                FString message          = isEmpty ? TEXT( "---" ) : InputEntryToString( entry.m_InputEntry );
-
-                FColor color = entry.m_Used ? FColor::Red : FColor::Green;
+                FString message = FString::Printf( TEXT( "%s [-%u]" ), *InputEntryToString( static_cast<EInputEntry>(_key) ), currentFrame - _frame );
+                FColor color    = _consumed ? FColor::Red : FColor::Green;
 
-                GEngine->AddOnScreenDebugMessage( i, 1.f, color, FString::Printf( TEXT( "%s" ), *message ) );
-            }
+                GEngine->AddOnScreenDebugMessage( messageKey++, 1.f, color, message );
+            } );
         }
     }
 
@@ -98,311 +271,352 @@ void UMovesBufferComponent::TickComponent( float DeltaTime, ELevelTick TickType,
     {
         if( m_OwnerCharacter && m_OwnerCharacter->m_PlayerIndex == 0 )
         {
-            for( int32 i = 0; i < m_InputsSequenceBuffer.size(); ++i )
+            int32 messageKey = 20;
+            m_InputsSequenceBuffer->ForEachWithinFrames( currentFrame, m_InputsSequencesBufferSizeFrames, [&]( int32 _key, uint32 _frame, bool _consumed )
             {
-                FInputsSequenceBufferEntry& entry = m_InputsSequenceBuffer.at( i );
-                bool isEmpty                      = entry.m_InputsSequenceName == FInputsSequenceBufferEntry::s_SequenceNone;
-                FString message                   = isEmpty ? TEXT( "---" ) : entry.m_InputsSequenceName.ToString();
-
-                FColor color = entry.m_Used ? FColor::Red : FColor::Green;
+                FString message = FString::Printf( TEXT( "%s [-%u]" ), *GetInputsSequenceName( _key ).ToString(), currentFrame - _frame );
+                FColor color    = _consumed ? FColor::Red : FColor::Green;
 
-                GEngine->AddOnScreenDebugMessage( i + 20, 1.f, color, FString::Printf( TEXT( "%s" ), *message ) );
-            }
+                GEngine->AddOnScreenDebugMessage( messageKey++, 1.f, color, message );
+            } );
         }
     }
+}
 
-    m_IBBufferChanged  = false;
-    m_ISBBufferChanged = false;
+FRawInputFrame UMovesBufferComponent::CollectRawInputFrame()
+{
+    // Button events are received at render rate and latched until the next sample
+    FRawInputFrame rawFrame = m_PendingRawFrame;
+    m_PendingRawFrame.ClearEdges();
 
-    UpdateMovementDirection();
+    FMemory::Memcpy( m_SampledPressCycles, m_PendingPressCycles, sizeof( m_PendingPressCycles ) );
+    FMemory::Memzero( m_PendingPressCycles, sizeof( m_PendingPressCycles ) );
 
     if( m_PlayerInput )
     {
-        float horizontalMovement = m_PlayerInput->GetAxisValue( TEXT( "MoveHorizontal" ) );
-
-        m_InputMovement = horizontalMovement;
-
-        m_MovingRight = horizontalMovement > m_AnalogMovementDeadzone;
-        m_MovingLeft  = horizontalMovement < -m_AnalogMovementDeadzone;
-
-        UpdateDirectionalInputs( m_PlayerInput );
+        rawFrame.m_StickX = FDirectionalInputQuantizer::QuantizeAxis( ReadAxis( m_MoveHorizontalAxis ) );
+        rawFrame.m_StickY = FDirectionalInputQuantizer::QuantizeAxis( ReadAxis( m_MoveVerticalAxis ) );
     }
-}
 
-void UMovesBufferComponent::OnSetupPlayerInputComponent( UInputComponent* PlayerInputComponent )
-{
-    m_PlayerInput = PlayerInputComponent;
-    if( m_PlayerInput )
+    // An exhausted source leaves the live frame untouched
+    if( m_InputSource )
     {
-        FName jumpAction           = TEXT( "Jump" );
-        FName attackAction         = TEXT( "Attack" );
-        FName specialAction        = TEXT( "Special" );
-        FName moveHorizontalAction = TEXT( "MoveHorizontal" );
-        FName moveVerticalAction   = TEXT( "MoveVertical" );
-
-        m_PlayerInput->BindAction( jumpAction, IE_Pressed, this, &UMovesBufferComponent::OnStartJump );
-        m_PlayerInput->BindAction( jumpAction, IE_Released, this, &UMovesBufferComponent::OnStopJump );
-        m_PlayerInput->BindAction( attackAction, IE_Pressed, this, &UMovesBufferComponent::OnAttack );
-        m_PlayerInput->BindAction( specialAction, IE_Pressed, this, &UMovesBufferComponent::OnSpecial );
-
-        m_PlayerInput->BindAxis( moveHorizontalAction );
-        m_PlayerInput->BindAxis( moveVerticalAction );
+        if( m_InputSource->PollFrame( rawFrame ) )
+        {
+            // Generated frames have no event time, their latency starts at sampling
+            FMemory::Memzero( m_SampledPressCycles, sizeof( m_SampledPressCycles ) );
+        }
+        else
+        {
+            m_InputSource.Reset();
+        }
     }
 
-    InitInputBuffer();
+    if( m_Recording )
+    {
+        m_Recording->Append( rawFrame );
+    }
 
-    InitInputsSequenceBuffer();
+    return rawFrame;
 }
 
-bool UMovesBufferComponent::IsInputBuffered( EInputEntry Input, bool ConsumeEntry )
+void UMovesBufferComponent::ProcessRawInputFrame( const FRawInputFrame& RawFrame, EInputEntry DirectionalEntry )
 {
-    for( int32 i = 0; i < m_InputsBuffer.size(); ++i )
+    for( const FButtonBinding& binding : loc_ButtonBindings )
     {
-        FInputBufferEntry& entry = m_InputsBuffer.at( i );
-        if( entry.m_InputEntry != EInputEntry::None && entry.m_InputEntry == Input && !entry.m_Used )
+        // Edges are replayed in the order they were received, latency is measured from the first press of the sample
+        uint64 pressCycles = m_SampledPressCycles[static_cast<int32>(binding.m_Button)];
+        bool isPress       = RawFrame.IsFirstEdgePress( binding.m_Button );
+
+        for( int32 edge = RawFrame.GetEdgeCount( binding.m_Button ); edge > 0; --edge )
         {
-            if( ConsumeEntry )
+            if( isPress )
+            {
+                AddToInputBuffer( binding.m_PressedEntry, pressCycles );
+                pressCycles = 0;
+            }
+            else
             {
-                entry.m_Used = true;
+                AddToInputBuffer( binding.m_ReleasedEntry );
             }
-            return true;
+
+            isPress = !isPress;
         }
     }
 
-    return false;
+    float horizontalMovement = RawFrame.m_StickX / 127.f;
+
+    m_InputMovement = horizontalMovement;
+
+    m_MovingRight = horizontalMovement > m_AnalogMovementDeadzone;
+    m_MovingLeft  = horizontalMovement < -m_AnalogMovementDeadzone;
+
+    UpdateDirectionalInputs( DirectionalEntry );
+
+    UpdateMovementDirection();
 }
 
-float UMovesBufferComponent::GetMovementDirection() const
+void UMovesBufferComponent::SetInputSource( TSharedPtr<IInputFrameSource> InputSource )
 {
-    return m_MovementDirection;
+    m_InputSource = InputSource;
+
+    // Edges received from the live input before the switch belong to neither source, the buttons stay held
+    m_PendingRawFrame.ClearEdges();
 }
 
-EInputEntry UMovesBufferComponent::GetDirectionalInputEntryFromAngle( float Angle ) const
+void UMovesBufferComponent::StartRecording()
 {
-    static float forwardAngle = 90.f;
-    static float downAngle    = 180.f;
-    static float backAngle    = -90.f;
-    static float upAngle      = 0.f;
+    m_Recording = MakeShared<FInputRecording>();
+    m_Recording->Reset( 1.f / m_InputSampler->GetStepDuration() );
+}
 
-    // Up
-    if( Angle > upAngle - m_DirectionalChangeRotationEpsilon && Angle < upAngle + m_DirectionalChangeRotationEpsilon )
+TSharedPtr<FInputRecording> UMovesBufferComponent::StopRecording()
+{
+    TSharedPtr<FInputRecording> recording = MoveTemp( m_Recording );
+    if( recording )
     {
-        return EInputEntry::Up;
+        recording->Finish();
     }
 
-    // Up-forward
-    if( Angle >= upAngle + m_DirectionalChangeRotationEpsilon && Angle < forwardAngle - m_DirectionalChangeRotationEpsilon )
-    {
-        return EInputEntry::UpForward;
-    }
+    return recording;
+}
 
-    // Forward
-    if( Angle > forwardAngle - m_DirectionalChangeRotationEpsilon && Angle < forwardAngle + m_DirectionalChangeRotationEpsilon )
+void UMovesBufferComponent::OnSetupPlayerInputComponent( UInputComponent* PlayerInputComponent )
+{
+    m_PlayerInput = PlayerInputComponent;
+    if( m_PlayerInput )
     {
-        return EInputEntry::Forward;
-    }
+        for( const FButtonBinding& binding : loc_ButtonBindings )
+        {
+            FInputActionBinding pressedBinding( binding.m_ActionName, IE_Pressed );
+            pressedBinding.ActionDelegate.GetDelegateForManualSet().BindUObject( this, &UMovesBufferComponent::OnButtonPressed, binding.m_Button );
+            m_PlayerInput->AddActionBinding( MoveTemp( pressedBinding ) );
 
-    // Forward-down
-    if( Angle >= forwardAngle + m_DirectionalChangeRotationEpsilon && Angle < downAngle - m_DirectionalChangeRotationEpsilon )
-    {
-        return EInputEntry::ForwardDown;
-    }
+            FInputActionBinding releasedBinding( binding.m_ActionName, IE_Released );
+            releasedBinding.ActionDelegate.GetDelegateForManualSet().BindUObject( this, &UMovesBufferComponent::OnButtonReleased, binding.m_Button );
+            m_PlayerInput->AddActionBinding( MoveTemp( releasedBinding ) );
+        }
 
-    // Down
-    if( (Angle >= downAngle && Angle >= downAngle - m_DirectionalChangeRotationEpsilon) ||
-        (Angle > -downAngle && Angle < -downAngle + m_DirectionalChangeRotationEpsilon) )
-    {
-        return EInputEntry::Down;
+        m_MoveHorizontalAxis = BindAxisHandle( TEXT( "MoveHorizontal" ) );
+        m_MoveVerticalAxis   = BindAxisHandle( TEXT( "MoveVertical" ) );
     }
 
-    // Down-back
-    if( Angle > -downAngle + m_DirectionalChangeRotationEpsilon && Angle < backAngle - m_DirectionalChangeRotationEpsilon )
+    InitInputBuffer();
+
+    InitInputsSequenceBuffer();
+}
+
+bool UMovesBufferComponent::IsInputBuffered( EInputEntry Input, bool ConsumeEntry, int32 WithinFrames )
+{
+    if( Input == EInputEntry::None || Input >= EInputEntry::COUNT )
     {
-        return EInputEntry::DownBackward;
+        return false;
     }
 
-    // Back
-    if( Angle > backAngle - m_DirectionalChangeRotationEpsilon && Angle < backAngle + m_DirectionalChangeRotationEpsilon )
+    const uint32 window = GetInputBufferWindow( WithinFrames );
+
+    if( !ConsumeEntry )
     {
-        return EInputEntry::Backward;
+        return m_InputsBuffer->Contains( static_cast<int32>(Input), m_InputSampler->GetFrame(), window );
     }
 
-    // Back-Up
-    if( Angle >= backAngle + m_DirectionalChangeRotationEpsilon && Angle < upAngle - m_DirectionalChangeRotationEpsilon )
+    if( m_InputsBuffer->Consume( static_cast<int32>(Input), m_InputSampler->GetFrame(), window ) )
     {
-        return EInputEntry::BackwardUp;
+        m_LatencyTracker.OnInputConsumed( Input );
+        return true;
     }
 
-    return EInputEntry::None;
+    return false;
 }
 
-void UMovesBufferComponent::OnInputRouteEnded( TObjectPtr<UInputsSequence> InputsSequence )
+uint32 UMovesBufferComponent::GetInputBufferWindow( int32 WithinFrames ) const
 {
-    AddToInputsSequenceBuffer( InputsSequence->m_Name, InputsSequence->m_Priority );
+    return WithinFrames > 0 ? FMath::Min( WithinFrames, m_InputBufferSizeFrames ) : m_InputBufferSizeFrames;
 }
 
-void UMovesBufferComponent::AddToInputBuffer( EInputEntry InputEntry )
+float UMovesBufferComponent::GetMovementDirection() const
 {
-    EInputEntry targetEntry = m_OwnerCharacter->IsFacingRight() ? InputEntry : GetMirrored( InputEntry );
+    return m_MovementDirection;
+}
 
-    m_InputsBuffer.emplace_back( FInputBufferEntry{targetEntry, false} );
-    m_InputsBuffer.pop_front();
+void UMovesBufferComponent::BuildDirectionalQuantizer()
+{
+    FDirectionalInputQuantizerSettings settings;
+    settings.m_AxisDeadzone    = m_AnalogMovementDeadzone;
+    settings.m_MinVectorLength = m_MinDirectionalInputVectorLength;
+    settings.m_RotationEpsilon = m_DirectionalChangeRotationEpsilon;
+    settings.m_Gate            = m_StickGate;
 
-    m_IBBufferChanged = true;
+    m_DirectionalQuantizer.Build( settings );
+}
 
-    if( InputEntry != EInputEntry::None )
+void UMovesBufferComponent::OnInputRouteEnded( TObjectPtr<UInputsSequence> InputsSequence )
+{
+    const int32 inputsSequenceId = GetInputsSequenceId( InputsSequence->m_Name );
+    if( inputsSequenceId != INDEX_NONE )
     {
-        m_InputSequenceResolver->RegisterInput( targetEntry );
+        m_InputsSequenceBuffer->Push( inputsSequenceId, m_InputSampler->GetFrame() );
+
+        m_LatencyTracker.OnInputsSequenceBuffered( inputsSequenceId );
     }
 }
 
-bool UMovesBufferComponent::InputBufferContainsConsumable( EInputEntry InputEntry ) const
+void UMovesBufferComponent::AddToInputBuffer( EInputEntry InputEntry, uint64 EventCycles )
 {
-    for( const FInputBufferEntry& entry : m_InputsBuffer )
+    EInputEntry targetEntry = m_OwnerCharacter->IsFacingRight() ? InputEntry : GetMirrored( InputEntry );
+
+    if( targetEntry == EInputEntry::None )
     {
-        if( entry.m_InputEntry == InputEntry && !entry.m_Used )
-        {
-            return true;
-        }
+        return;
     }
 
-    return false;
+    m_InputsBuffer->Push( static_cast<int32>(targetEntry), m_InputSampler->GetFrame() );
+
+    m_LatencyTracker.OnInputSampled( targetEntry, EventCycles, m_InputSampler->GetFrame() );
+
+    m_InputSequenceResolver->RegisterInput( targetEntry, m_InputSampler->GetFrame(), m_OwnerCharacter->IsAirborne() );
 }
 
-void UMovesBufferComponent::AddToInputsSequenceBuffer( const FName& InputsSequenceName, int32 Priority )
+bool UMovesBufferComponent::InputBufferContainsConsumable( EInputEntry InputEntry ) const
 {
-    m_InputsSequenceBuffer.emplace_back( FInputsSequenceBufferEntry{InputsSequenceName, Priority, false} );
-    m_InputsSequenceBuffer.pop_front();
+    return m_InputsBuffer->Contains( static_cast<int32>(InputEntry), m_InputSampler->GetFrame(), m_InputBufferSizeFrames );
+}
 
-    m_ISBBufferChanged = true;
+bool UMovesBufferComponent::InputsSequenceBufferContainsConsumable( int32 InputsSequenceId ) const
+{
+    return m_InputsSequenceBuffer->Contains( InputsSequenceId, m_InputSampler->GetFrame(), m_InputsSequencesBufferSizeFrames );
 }
 
-bool UMovesBufferComponent::InputsSequenceBufferContainsConsumable( const FName& MoveName )
+int32 UMovesBufferComponent::GetInputsSequenceId( const FName& InputsSequenceName ) const
 {
-    for( const FInputsSequenceBufferEntry& entry : m_InputsSequenceBuffer )
-    {
-        if( entry.m_InputsSequenceName == MoveName && !entry.m_Used )
-        {
-            return true;
-        }
-    }
+    const int32* inputsSequenceId = m_InputsSequenceIds.Find( InputsSequenceName );
+    return inputsSequenceId ? *inputsSequenceId : INDEX_NONE;
+}
 
-    return false;
+const FName& UMovesBufferComponent::GetInputsSequenceName( int32 InputsSequenceId ) const
+{
+    static const FName s_None = NAME_None;
+    return m_InputsList.IsValidIndex( InputsSequenceId ) && m_InputsList[InputsSequenceId] ? m_InputsList[InputsSequenceId]->m_Name : s_None;
+}
+
+int32 UMovesBufferComponent::GetBestBufferedInputsSequence()
+{
+    return m_InputsSequenceBuffer->FindBestRanked( m_InputSampler->GetFrame(), m_InputsSequencesBufferSizeFrames );
 }
 
 void UMovesBufferComponent::ClearInputsBuffer()
 {
-    m_InputsBuffer.clear();
+    m_InputsBuffer->Reset();
 }
 
 void UMovesBufferComponent::InitInputBuffer()
 {
-    ClearInputsBuffer();
-
-    for( int32 i = 0; i < m_InputBufferSizeFrames; ++i )
-    {
-        m_InputsBuffer.emplace_back( FInputBufferEntry{EInputEntry::None, false} );
-    }
+    m_InputsBuffer->Init( static_cast<int32>(EInputEntry::COUNT) );
 }
 
 void UMovesBufferComponent::UseBufferedInputsSequence( const FName& InputsSequenceName )
 {
-    verify( InputsSequenceBufferContainsConsumable( InputsSequenceName ) );
+    const int32 inputsSequenceId = GetInputsSequenceId( InputsSequenceName );
+    verify( inputsSequenceId != INDEX_NONE && InputsSequenceBufferContainsConsumable( inputsSequenceId ) );
 
-    for( FInputsSequenceBufferEntry& entry : m_InputsSequenceBuffer )
-    {
-        if( entry.m_InputsSequenceName == InputsSequenceName )
-        {
-            entry.m_Used = true;
-        }
-    }
+    m_InputsSequenceBuffer->ConsumeAll( inputsSequenceId );
+
+    m_LatencyTracker.OnInputsSequenceConsumed( inputsSequenceId );
 }
 
 void UMovesBufferComponent::ClearInputsSequenceBuffer()
 {
-    m_InputsSequenceBuffer.clear();
+    m_InputsSequenceBuffer->Reset();
 }
 
 void UMovesBufferComponent::InitInputsSequenceBuffer()
 {
-    ClearInputsSequenceBuffer();
+    m_InputsSequenceBuffer->Init( m_InputsList.Num(), m_InputsSequenceRanks );
+}
 
-    for( int i = 0; i < m_InputsSequencesBufferSizeFrames; ++i )
-    {
-        m_InputsSequenceBuffer.emplace_back( FInputsSequenceBufferEntry{FInputsSequenceBufferEntry::s_SequenceNone, false} );
-    }
+void UMovesBufferComponent::InvalidateInputsSequenceBuffer()
+{
+    m_InputsSequenceBuffer->Invalidate();
 }
 
-void UMovesBufferComponent::GetInputsSequenceBufferSnapshot( TArray<FInputsSequenceBufferEntry>& OutEntries, bool SkipEmptyEntries )
+bool UMovesBufferComponent::IsInputsSequenceBuffered( const FName& InputsSequenceName, bool ConsumeEntry /*= true*/ )
 {
-    OutEntries.Reset();
+    return IsInputsSequenceIdBuffered( GetInputsSequenceId( InputsSequenceName ), ConsumeEntry );
+}
 
-    for( const auto& entry : m_InputsSequenceBuffer )
+bool UMovesBufferComponent::IsInputsSequenceIdBuffered( int32 InputsSequenceId, bool ConsumeEntry )
+{
+    if( !m_InputsList.IsValidIndex( InputsSequenceId ) )
     {
-        bool currentEntryIsNone = entry.m_InputsSequenceName == FInputsSequenceBufferEntry::s_SequenceNone;
-        if( SkipEmptyEntries && currentEntryIsNone )
-        {
-            continue;
-        }
+        return false;
+    }
 
-        OutEntries.Emplace( entry );
+    if( !ConsumeEntry )
+    {
+        return m_InputsSequenceBuffer->Contains( InputsSequenceId, m_InputSampler->GetFrame(), m_InputsSequencesBufferSizeFrames );
     }
-}
 
-bool UMovesBufferComponent::IsInputsSequenceBuffered( const FName& InputsSequenceName, bool ConsumeEntry /*= true*/ )
-{
-    for( int32 i = 0; i < m_InputsSequenceBuffer.size(); ++i )
+    if( m_InputsSequenceBuffer->Consume( InputsSequenceId, m_InputSampler->GetFrame(), m_InputsSequencesBufferSizeFrames ) )
     {
-        FInputsSequenceBufferEntry& entry = m_InputsSequenceBuffer.at( i );
+        m_LatencyTracker.OnInputsSequenceConsumed( InputsSequenceId );
+        return true;
+    }
 
-        bool isValid     = entry.m_InputsSequenceName != FInputsSequenceBufferEntry::s_SequenceNone;
-        bool hasSameName = entry.m_InputsSequenceName == InputsSequenceName;
-        bool canBeUsed   = !entry.m_Used;
+    return false;
+}
 
-        if( isValid && hasSameName && canBeUsed )
-        {
-            if( ConsumeEntry )
-            {
-                entry.m_Used = true;
-            }
+UMovesBufferComponent::FInputAxisHandle UMovesBufferComponent::BindAxisHandle( const FName& AxisName )
+{
+    FInputAxisHandle axisHandle;
+    axisHandle.m_AxisName = AxisName;
 
-            return true;
-        }
-    }
+    m_PlayerInput->BindAxis( AxisName );
+    axisHandle.m_BindingIndex = m_PlayerInput->AxisBindings.Num() - 1;
 
-    return false;
+    return axisHandle;
 }
 
-void UMovesBufferComponent::OnMoveHorizontal( float Value )
+float UMovesBufferComponent::ReadAxis( FInputAxisHandle& AxisHandle )
 {
-    if( FMath::Abs( Value ) > m_AnalogMovementDeadzone )
+    const TArray<FInputAxisBinding>& axisBindings = m_PlayerInput->AxisBindings;
+
+    // Bindings added or removed by someone else can shift the index, fall back to a single search then
+    if( !axisBindings.IsValidIndex( AxisHandle.m_BindingIndex ) || axisBindings[AxisHandle.m_BindingIndex].AxisName != AxisHandle.m_AxisName )
     {
-        m_InputMovement = Value;
+        AxisHandle.m_BindingIndex = axisBindings.IndexOfByPredicate( [&]( const FInputAxisBinding& _binding )
+        {
+            return _binding.AxisName == AxisHandle.m_AxisName;
+        } );
 
-        m_MovingRight = FMath::Sign( Value ) > 0;
-        m_MovingLeft  = FMath::Sign( Value ) < 0;
+        if( AxisHandle.m_BindingIndex == INDEX_NONE )
+        {
+            return 0.f;
+        }
     }
-}
 
-// TODO: these are all the same, make it generic maybe?
-void UMovesBufferComponent::OnStartJump()
-{
-    AddToInputBuffer( EInputEntry::StartJump );
+    return axisBindings[AxisHandle.m_BindingIndex].AxisValue;
 }
 
-void UMovesBufferComponent::OnStopJump()
+void UMovesBufferComponent::OnButtonPressed( ERawInputButton Button )
 {
-    AddToInputBuffer( EInputEntry::StopJump );
+    // Latency is measured from the first press received since the last sample
+    uint64& pressCycles = m_PendingPressCycles[static_cast<int32>(Button)];
+    if( pressCycles == 0 && !m_PendingRawFrame.IsHeld( Button ) )
+    {
+        pressCycles = FPlatformTime::Cycles64();
+    }
+
+    m_PendingRawFrame.Press( Button );
 }
 
-void UMovesBufferComponent::OnAttack()
+void UMovesBufferComponent::OnMontageFirstFrame( UAnimMontage* Montage )
 {
-    AddToInputBuffer( EInputEntry::Attack );
+    m_LatencyTracker.OnMontageFirstFrame();
 }
 
-void UMovesBufferComponent::OnSpecial()
+void UMovesBufferComponent::OnButtonReleased( ERawInputButton Button )
 {
-    AddToInputBuffer( EInputEntry::Special );
+    m_PendingRawFrame.Release( Button );
 }
 
 void UMovesBufferComponent::UpdateMovementDirection()
@@ -424,16 +638,17 @@ void UMovesBufferComponent::UpdateMovementDirection()
     }
 }
 
-void UMovesBufferComponent::UpdateDirectionalInputs( UInputComponent* InputComponent )
+void UMovesBufferComponent::UpdateDirectionalInputs( EInputEntry DirectionalEntry )
 {
-    m_DirectionalInputVector.X = InputComponent->GetAxisValue( "MoveHorizontal" );
-    m_DirectionalInputVector.Y = InputComponent->GetAxisValue( "MoveVertical" );
-
-    if( m_DirectionalInputVector.Length() > m_MinDirectionalInputVectorLength )
+    // Neutral and dead zones map to None and reset the last direction, so holding a direction doesn't repeat its entry
+    // but returning to it through neutral does (e.g. 22, 66)
+    const EInputEntry entry = DirectionalEntry;
+    if( entry == EInputEntry::None )
+    {
+        m_LastDirectionalInputEntry = EInputEntry::None;
+    }
+    else
     {
-        float angle       = UMathStatics::GetSignedAngle( m_DirectionalInputVector, FVector2d( 0.f, 1.f ) );
-        EInputEntry entry = GetDirectionalInputEntryFromAngle( angle );
-
         if( loc_ShowDirectionalAngle )
         {
             UKismetSystemLibrary::DrawDebugString( GetWorld(), GetOwner()->GetActorLocation(),
@@ -447,19 +662,14 @@ void UMovesBufferComponent::UpdateDirectionalInputs( UInputComponent* InputCompo
             AddToInputBuffer( entry );
         }
     }
-
-    m_LastDirectionalInputVector = m_DirectionalInputVector;
 }
 
 void UMovesBufferComponent::UseBufferedInput( EInputEntry Input )
 {
     verify( InputBufferContainsConsumable( Input ) );
 
-    for( FInputBufferEntry& entry : m_InputsBuffer )
-    {
-        if( entry.m_InputEntry == Input )
-        {
-            entry.m_Used = true;
-        }
-    }
+    // Occurrences older than the window can never come back into it, so consuming all of them is equivalent
+    m_InputsBuffer->ConsumeAll( static_cast<int32>(Input) );
+
+    m_LatencyTracker.OnInputConsumed( Input );
 }
@@ -4,32 +4,23 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
-#include <deque>
 
+#include "ConsumableInputBuffer.h"
+#include "DirectionalInputQuantizer.h"
+#include "FixedStepSampler.h"
+#include "InputLatencyTracker.h"
+#include "RawInputFrame.h"
 #include "InputEntry.h"
 #include "FightingGame/Combat/MoveDataAsset.h"
 #include "FightingGame/FSM/FightingCharacterState.h"
 #include "MovesBufferComponent.generated.h"
 
 class AFightingCharacter;
+class AInputManager;
+class FInputRecording;
 class UInputComponent;
 class UInputSequenceResolver;
 
-struct FInputBufferEntry
-{
-    EInputEntry m_InputEntry;
-    bool m_Used;
-};
-
-struct FInputsSequenceBufferEntry
-{
-    FName m_InputsSequenceName;
-    int32 m_Priority;
-    bool m_Used;
-
-    inline static FName s_SequenceNone = FName( TEXT( "" ) );
-};
-
 UCLASS( ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
 class FIGHTINGGAME_API UMovesBufferComponent : public UActorComponent
 {
@@ -44,8 +35,11 @@ public:
     UFUNCTION( BlueprintCallable )
     void UseBufferedInput( EInputEntry Input );
 
+    /*
+     * WithinFrames restricts the lookup to the most recent frames, 0 uses the whole buffer
+     */
     UFUNCTION( BlueprintCallable )
-    bool IsInputBuffered( EInputEntry Input, bool ConsumeEntry = true );
+    bool IsInputBuffered( EInputEntry Input, bool ConsumeEntry = true, int32 WithinFrames = 0 );
 
     UFUNCTION( BlueprintCallable )
     void ClearInputsBuffer();
@@ -67,10 +61,69 @@ public:
     UFUNCTION( BlueprintCallable )
     void InitInputsSequenceBuffer();
 
-    void GetInputsSequenceBufferSnapshot( TArray<FInputsSequenceBufferEntry>& OutEntries, bool SkipEmptyEntries );
+    /*
+     * Every sequence buffered so far is treated as consumed, cheap enough to call on every cancel
+     */
+    UFUNCTION( BlueprintCallable )
+    void InvalidateInputsSequenceBuffer();
+
+    /*
+     * Sequence IDs are the indices in the inputs list, assigned once at BeginPlay
+     */
+    int32 GetInputsSequenceId( const FName& InputsSequenceName ) const;
+    const FName& GetInputsSequenceName( int32 InputsSequenceId ) const;
+
+    bool IsInputsSequenceIdBuffered( int32 InputsSequenceId, bool ConsumeEntry = true );
+
+    /*
+     * ID of the buffered unconsumed sequence with the best priority (lowest value), the most recent one on ties.
+     * INDEX_NONE if nothing is buffered.
+     */
+    int32 GetBestBufferedInputsSequence();
 
     // MOVES BUFFER [END]
 
+    // INPUT SOURCE [BEGIN]
+    /*
+     * Replaces the live input with the given source until it is exhausted, null goes back to the live input
+     */
+    void SetInputSource( TSharedPtr<IInputFrameSource> InputSource );
+    FORCEINLINE bool HasInputSource() const { return m_InputSource.IsValid(); }
+
+    /*
+     * Records every sampled raw frame, from the live input or the current source
+     */
+    void StartRecording();
+    TSharedPtr<FInputRecording> StopRecording();
+    FORCEINLINE bool IsRecording() const { return m_Recording.IsValid(); }
+    // INPUT SOURCE [END]
+
+    /*
+     * The grounded/airborne flags of the registered moves decide in which stance each sequence of the inputs list is matched.
+     * The FSM states register the move they execute when they are initialized
+     */
+    void RegisterMove( UMoveDataAsset* Move );
+
+    // INPUT MANAGER [BEGIN]
+    /*
+     * While registered the buffers and the sampler live in the manager slot and the component doesn't tick,
+     * the manager collects, quantizes and processes the frames of every player in one pass.
+     */
+    void RegisterToInputManager( AInputManager* InputManager );
+    void UnregisterFromInputManager();
+
+    FRawInputFrame CollectRawInputFrame();
+    void ProcessRawInputFrame( const FRawInputFrame& RawFrame, EInputEntry DirectionalEntry );
+    void UpdateDebugDisplay();
+
+    FORCEINLINE const FDirectionalInputQuantizer& GetDirectionalQuantizer() const { return m_DirectionalQuantizer; }
+    int32 GetPlayerIndex() const;
+    void OnPlayerIndexChanged();
+    // INPUT MANAGER [END]
+
+    FORCEINLINE FInputLatencyTracker& GetLatencyTracker() { return m_LatencyTracker; }
+    void OnMontageFirstFrame( UAnimMontage* Montage );
+
     UPROPERTY( BlueprintReadOnly, DisplayName = "Input Movement" )
     float m_InputMovement = 0.f;
 
@@ -81,17 +134,18 @@ public:
     bool m_MovingLeft = false;
 
 protected:
-    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Inputs Buffer Size Frames" )
-    int32 m_InputBufferSizeFrames = 6;
-
-    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Inputs Sequence Buffer Size Frames" )
-    int32 m_InputsSequencesBufferSizeFrames = 10;
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Inputs Buffer Size Frames", meta = (ClampMin = "1", ClampMax = "64") )
+    int32 m_InputBufferSizeFrames = 12;
 
-    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Input Buffer Frame Rate (FPS)" )
-    float m_InputBufferFrameRate = 30;
+    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Inputs Sequence Buffer Size Frames", meta = (ClampMin = "1", ClampMax = "64") )
+    int32 m_InputsSequencesBufferSizeFrames = 20;
 
-    UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Inputs Sequence Buffer Frame Rate (FPS)" )
-    float m_InputsSequencesBufferFrameRate = 30;
+    /*
+     * Fixed rate at which inputs are sampled into the buffers, independent from the render frame rate.
+     * Buffer sizes are expressed in frames of this rate. Ignored while an input manager drives the component.
+     */
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Input Sample Rate (FPS)", meta = (ClampMin = "1") )
+    float m_InputSampleRate = 60.f;
 
     UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Analog Movement Deadzone" )
     float m_AnalogMovementDeadzone = 0.1f;
@@ -102,6 +156,9 @@ protected:
     UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Directional Change Rotation Epsilon" )
     float m_DirectionalChangeRotationEpsilon = 15.f;
 
+    UPROPERTY( EditAnywhere, BlueprintReadOnly, DisplayName = "Stick Gate" )
+    EStickGate m_StickGate = EStickGate::Circular;
+
     UPROPERTY( EditAnywhere, BlueprintReadWrite, DisplayName = "Inputs List" )
     TArray<TObjectPtr<UInputsSequence>> m_InputsList;
 
@@ -109,6 +166,7 @@ protected:
     TSubclassOf<UInputSequenceResolver> m_InputSequenceResolverClass = nullptr;
 
     virtual void BeginPlay() override;
+    virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
 
 public:
     virtual void TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
@@ -122,39 +180,70 @@ private:
     UPROPERTY()
     UInputComponent* m_PlayerInput = nullptr;
 
+    /*
+     * Index of an axis binding in the input component, resolved once so sampling doesn't search the bindings by name
+     */
+    struct FInputAxisHandle
+    {
+        FName m_AxisName;
+        int32 m_BindingIndex = INDEX_NONE;
+    };
+
+    FInputAxisHandle m_MoveHorizontalAxis;
+    FInputAxisHandle m_MoveVerticalAxis;
+
     UPROPERTY()
     TObjectPtr<UInputSequenceResolver> m_InputSequenceResolver = nullptr;
 
-    std::deque<FInputBufferEntry> m_InputsBuffer;
-    float m_IBElapsedFrameTime = 0.f;
-    bool m_IBBufferChanged     = false;
+    UPROPERTY()
+    TArray<TObjectPtr<UMoveDataAsset>> m_Moves;
+
+    UPROPERTY()
+    TObjectPtr<AInputManager> m_InputManager = nullptr;
+    int32 m_InputSlot = INDEX_NONE;
+
+    // Point either to the input manager slot or to the local storage below
+    FFixedStepSampler* m_InputSampler              = &m_LocalInputSampler;
+    FConsumableInputBuffer* m_InputsBuffer         = &m_LocalInputsBuffer;
+    FConsumableInputBuffer* m_InputsSequenceBuffer = &m_LocalInputsSequenceBuffer;
+
+    FFixedStepSampler m_LocalInputSampler;
+    FConsumableInputBuffer m_LocalInputsBuffer;
+    FConsumableInputBuffer m_LocalInputsSequenceBuffer;
+
+    FRawInputFrame m_PendingRawFrame;
+    uint64 m_PendingPressCycles[static_cast<int32>(ERawInputButton::COUNT)] = {};
+    uint64 m_SampledPressCycles[static_cast<int32>(ERawInputButton::COUNT)] = {};
 
-    std::deque<FInputsSequenceBufferEntry> m_InputsSequenceBuffer;
-    float m_ISBElapsedFrameTime = 0.f;
-    bool m_ISBBufferChanged     = false;
+    FInputLatencyTracker m_LatencyTracker;
+
+    TSharedPtr<IInputFrameSource> m_InputSource;
+    TSharedPtr<FInputRecording> m_Recording;
+
+    TMap<FName, int32> m_InputsSequenceIds;
+    TArray<uint8> m_InputsSequenceRanks;
 
     float m_MovementDirection = 0.f;
 
-    FVector2D m_LastDirectionalInputVector;
-    FVector2D m_DirectionalInputVector;
+    FDirectionalInputQuantizer m_DirectionalQuantizer;
     EInputEntry m_LastDirectionalInputEntry = EInputEntry::None;
 
-    void AddToInputBuffer( EInputEntry InputEntry );
+    void AddToInputBuffer( EInputEntry InputEntry, uint64 EventCycles = 0 );
+    void OnButtonPressed( ERawInputButton Button );
+    void OnButtonReleased( ERawInputButton Button );
     bool InputBufferContainsConsumable( EInputEntry InputEntry ) const;
+    uint32 GetInputBufferWindow( int32 WithinFrames ) const;
 
-    void AddToInputsSequenceBuffer( const FName& InputsSequenceName, int32 Priority );
-    bool InputsSequenceBufferContainsConsumable( const FName& MoveName );
-
-    void OnMoveHorizontal( float Value );
+    TArray<TTuple<bool, bool>> BuildGroundedAirborneFlags() const;
+    void BuildInputsSequenceRegistry();
+    bool InputsSequenceBufferContainsConsumable( int32 InputsSequenceId ) const;
 
-    void OnStartJump();
-    void OnStopJump();
-    void OnAttack();
-    void OnSpecial();
+    FInputAxisHandle BindAxisHandle( const FName& AxisName );
+    float ReadAxis( FInputAxisHandle& AxisHandle );
 
     void UpdateMovementDirection();
-    void UpdateDirectionalInputs( UInputComponent* InputComponent );
-    EInputEntry GetDirectionalInputEntryFromAngle( float Angle ) const;
+    void UpdateDirectionalInputs( EInputEntry DirectionalEntry );
+    void BuildDirectionalQuantizer();
 
     void OnInputRouteEnded( TObjectPtr<UInputsSequence> InputsSequence );
 };
@@ -0,0 +1,100 @@
+// Copyright (c) Giammarco Agazzotti
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ERawInputButton : uint8
+{
+    Jump,
+    Attack,
+    Special,
+
+    COUNT
+};
+
+FORCEINLINE constexpr uint8 GetRawInputButtonBit( ERawInputButton Button )
+{
+    return static_cast<uint8>(1 << static_cast<uint8>(Button));
+}
+
+/*
+ * Raw state of one player for one input sample, before mirroring and buffering.
+ * Buttons are stored as their held state at sampling time and the number of edges received since the previous sample,
+ * so taps shorter than a sample are not lost. Edges of a button alternate, the held state and the count rebuild their order.
+ * The stick is the quantized value at sampling time.
+ */
+struct FRawInputFrame
+{
+    static constexpr int32 s_EdgeCountBits = 2;
+    static constexpr int32 s_MaxEdgeCount  = (1 << s_EdgeCountBits) - 1;
+
+    uint8 m_Held  = 0;
+    uint8 m_Edges = 0; // s_EdgeCountBits per button
+    int8 m_StickX = 0;
+    int8 m_StickY = 0;
+
+    FORCEINLINE bool IsHeld( ERawInputButton Button ) const { return (m_Held & GetRawInputButtonBit( Button )) != 0; }
+
+    FORCEINLINE int32 GetEdgeCount( ERawInputButton Button ) const
+    {
+        return (m_Edges >> (static_cast<int32>(Button) * s_EdgeCountBits)) & s_MaxEdgeCount;
+    }
+
+    /*
+     * The first edge is a press when the button was released at the previous sample
+     */
+    FORCEINLINE bool IsFirstEdgePress( ERawInputButton Button ) const { return IsHeld( Button ) == ((GetEdgeCount( Button ) & 1) != 0); }
+
+    FORCEINLINE void Press( ERawInputButton Button ) { AddEdge( Button, true ); }
+    FORCEINLINE void Release( ERawInputButton Button ) { AddEdge( Button, false ); }
+
+    /*
+     * Starts the next sample, the held state carries over
+     */
+    FORCEINLINE void ClearEdges() { m_Edges = 0; }
+
+    FORCEINLINE bool operator==( const FRawInputFrame& Other ) const
+    {
+        return m_Held == Other.m_Held && m_Edges == Other.m_Edges && m_StickX == Other.m_StickX && m_StickY == Other.m_StickY;
+    }
+
+    FORCEINLINE bool operator!=( const FRawInputFrame& Other ) const { return !(*this == Other); }
+
+private:
+    void AddEdge( ERawInputButton Button, bool IsPress )
+    {
+        // A press of a held button or a release of a released one is a duplicated event
+        if( IsHeld( Button ) == IsPress )
+        {
+            return;
+        }
+
+        // Past the max count a press and release pair is dropped, the parity is kept so the order can still be rebuilt
+        int32 edgeCount = GetEdgeCount( Button ) + 1;
+        if( edgeCount > s_MaxEdgeCount )
+        {
+            edgeCount -= 2;
+        }
+
+        const int32 shift = static_cast<int32>(Button) * s_EdgeCountBits;
+        m_Edges           = static_cast<uint8>((m_Edges & ~(s_MaxEdgeCount << shift)) | (edgeCount << shift));
+        m_Held ^= GetRawInputButtonBit( Button );
+    }
+};
+
+static_assert( static_cast<int32>(ERawInputButton::COUNT) * FRawInputFrame::s_EdgeCountBits <= 8, "Edge counts of every button must fit in a byte" );
+
+/*
+ * Provides the raw frames for a moves buffer in place of its input component, e.g. a recording playback or a bot
+ */
+class IInputFrameSource
+{
+public:
+    virtual ~IInputFrameSource() = default;
+
+    /*
+     * Returns false once the source is exhausted, the moves buffer then goes back to its live input
+     */
+    virtual bool PollFrame( FRawInputFrame& OutFrame ) = 0;
+};
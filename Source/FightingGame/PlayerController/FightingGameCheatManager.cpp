@@ -2,3 +2,92 @@
 
 
 #include "FightingGameCheatManager.h"
+
+#include "EngineUtils.h"
+#include "FightingGame/Character/FightingCharacter.h"
+#include "FightingGame/Debugging/Debug.h"
+#include "FightingGame/Debugging/HitboxAllocationCounter.h"
+#include "FightingGame/Input/BotInputSource.h"
+#include "FightingGame/Input/InputRecording.h"
+#include "FightingGame/Input/MovesBufferComponent.h"
+
+void UFightingGameCheatManager::RecordInputs( const FString& RecordingName )
+{
+	m_RecordingName = RecordingName;
+
+	for( TActorIterator<AFightingCharacter> it( GetWorld() ); it; ++it )
+	{
+		it->GetMovesBufferComponent()->StartRecording();
+	}
+}
+
+void UFightingGameCheatManager::StopRecordingInputs()
+{
+	for( TActorIterator<AFightingCharacter> it( GetWorld() ); it; ++it )
+	{
+		TSharedPtr<FInputRecording> recording = it->GetMovesBufferComponent()->StopRecording();
+		if( !recording )
+		{
+			continue;
+		}
+
+		const FString filePath = FInputRecording::GetRecordingFilePath( m_RecordingName, it->m_PlayerIndex );
+		if( recording->SaveToFile( filePath ) )
+		{
+			FG_SLOG_INFO( FString::Printf( TEXT("Saved %u input frames (%d bytes) to %s"), recording->GetNumFrames(), recording->GetEncodedSize(), *filePath ) );
+		}
+		else
+		{
+			FG_SLOG_ERR( FString::Printf( TEXT("Could not save input recording to %s"), *filePath ) );
+		}
+	}
+}
+
+void UFightingGameCheatManager::PlayInputs( const FString& RecordingName, int32 StartFrame )
+{
+	for( TActorIterator<AFightingCharacter> it( GetWorld() ); it; ++it )
+	{
+		const FString filePath = FInputRecording::GetRecordingFilePath( RecordingName, it->m_PlayerIndex );
+
+		TSharedRef<FInputRecording> recording = MakeShared<FInputRecording>();
+		if( !recording->LoadFromFile( filePath ) )
+		{
+			FG_SLOG_ERR( FString::Printf( TEXT("Could not load input recording %s"), *filePath ) );
+			continue;
+		}
+
+		it->GetMovesBufferComponent()->SetInputSource( MakeShared<FInputPlaybackSource>( recording, FMath::Max( StartFrame, 0 ) ) );
+	}
+}
+
+void UFightingGameCheatManager::BotInputs( const FString& Policy, const FString& ReplayRecordingName, int32 Seed )
+{
+	const int64 policyValue = StaticEnum<EBotInputPolicy>()->GetValueByNameString( Policy );
+	if( policyValue == INDEX_NONE )
+	{
+		FG_SLOG_WARN( FString::Printf( TEXT("Unknown bot policy [%s]"), *Policy ) );
+		return;
+	}
+
+	for( TActorIterator<AFightingCharacter> it( GetWorld() ); it; ++it )
+	{
+		const int32 playerIndex = it->m_PlayerIndex;
+		it->GetMovesBufferComponent()->SetInputSource( CreateBotInputSource( static_cast<EBotInputPolicy>(policyValue), Seed + playerIndex, playerIndex, ReplayRecordingName ) );
+	}
+}
+
+void UFightingGameCheatManager::StopPlayingInputs()
+{
+	for( TActorIterator<AFightingCharacter> it( GetWorld() ); it; ++it )
+	{
+		it->GetMovesBufferComponent()->SetInputSource( nullptr );
+	}
+}
+
+void UFightingGameCheatManager::CountHitboxAllocations( int32 Frames, int32 WarmUpFrames, int32 Seed )
+{
+#if FG_COUNT_HITBOX_ALLOCATIONS
+	BotInputs( TEXT("MotionSpam"), TEXT(""), Seed );
+	FHitboxAllocationCounter::Start( WarmUpFrames, Frames );
+#endif
+}
@@ -11,4 +11,39 @@ UCLASS()
 class FIGHTINGGAME_API UFightingGameCheatManager : public UCheatManager
 {
 	GENERATED_BODY()
+
+public:
+	/*
+	 * Records the raw inputs of every character, saved on stop to Saved/InputRecordings/<Name>_P<PlayerIndex>.fgir
+	 */
+	UFUNCTION( Exec )
+	void RecordInputs( const FString& RecordingName );
+
+	UFUNCTION( Exec )
+	void StopRecordingInputs();
+
+	/*
+	 * Feeds every character from its recording, starting from the given input frame
+	 */
+	UFUNCTION( Exec )
+	void PlayInputs( const FString& RecordingName, int32 StartFrame = 0 );
+
+	UFUNCTION( Exec )
+	void StopPlayingInputs();
+
+	/*
+	 * Hands every character over to a bot input source (Mash, MotionSpam or Replay), StopPlayingInputs gives them back
+	 */
+	UFUNCTION( Exec )
+	void BotInputs( const FString& Policy, const FString& ReplayRecordingName = TEXT(""), int32 Seed = 0 );
+
+	/*
+	 * Runs a scripted fight (every character on a seeded MotionSpam bot) and logs the heap allocations of the hitbox path over the given frames.
+	 * The bots keep playing afterwards, StopPlayingInputs gives the characters back.
+	 */
+	UFUNCTION( Exec )
+	void CountHitboxAllocations( int32 Frames = 600, int32 WarmUpFrames = 120, int32 Seed = 0 );
+
+private:
+	FString m_RecordingName;
 };
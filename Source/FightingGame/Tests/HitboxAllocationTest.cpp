@@ -0,0 +1,136 @@
+// Copyright (c) Giammarco Agazzotti
+
+#include "Misc/AutomationTest.h"
+#include "FightingGame/Debugging/HitboxAllocationCounter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && FG_COUNT_HITBOX_ALLOCATIONS
+
+#include "Animation/AnimNotifyQueue.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "FightingGame/Character/FightingCharacter.h"
+#include "FightingGame/Combat/CombatManager.h"
+#include "FightingGame/Combat/HitboxHandlerComponent.h"
+#include "FightingGame/Combat/HitboxNotifyState.h"
+#include "FightingGame/Common/GameFramework.h"
+#include "FightingGame/Prop/Prop.h"
+
+namespace
+{
+	constexpr int32 loc_NumHitboxes   = 4;
+	constexpr int32 loc_WindowFrames  = 12;
+	constexpr int32 loc_ActiveFrames  = 8;
+	constexpr int32 loc_WarmUpWindows = 2;
+	constexpr int32 loc_Frames        = 60;
+	constexpr float loc_DeltaTime     = 1.f / 60.f;
+
+	/*
+	 * A character repeating a hitbox window on a prop, ticked in the engine order: the notify from the animation,
+	 * the handler removing the ended hitboxes, then the combat manager batch
+	 */
+	struct FHitboxComboFixture
+	{
+		AGameFramework* m_GameFramework    = nullptr;
+		ACombatManager* m_CombatManager    = nullptr;
+		AFightingCharacter* m_Attacker     = nullptr;
+		AProp* m_Target                    = nullptr;
+		UHitboxNotifyState* m_HitboxNotify = nullptr;
+
+		int32 m_Frame = 0;
+
+		void Init( UWorld* World )
+		{
+			m_GameFramework = World->SpawnActor<AGameFramework>();
+			m_CombatManager = World->SpawnActor<ACombatManager>();
+			m_CombatManager->OnRegister( *m_GameFramework );
+
+			m_Attacker = World->SpawnActor<AFightingCharacter>();
+			m_Target   = World->SpawnActor<AProp>();
+
+			// Covers the hitboxes whichever way the attacker faces
+			FHurtboxDescription hurtbox;
+			hurtbox.m_End    = FVector2D( 0.f, 100.f );
+			hurtbox.m_Radius = 80.f;
+			m_CombatManager->SetHurtboxSet( m_Target, m_CombatManager->RegisterHurtboxSet( { hurtbox } ) );
+
+			m_HitboxNotify = NewObject<UHitboxNotifyState>();
+			for( int32 i = 0; i < loc_NumHitboxes; ++i )
+			{
+				FHitboxDescription& hitbox = m_HitboxNotify->m_HitBoxes.Emplace_GetRef();
+				hitbox.m_UseLocation       = true;
+				hitbox.m_Location          = FVector( 0.f, 50.f, i * 25.f );
+				hitbox.m_Priority          = i;
+			}
+
+			// Not begun, BeginPlay would look for the manager of the game mode
+			m_Attacker->GetHitboxHandler()->SetCombatManager( m_CombatManager );
+		}
+
+		void ShutDown()
+		{
+			m_Attacker->GetHitboxHandler()->SetCombatManager( nullptr );
+			m_CombatManager->OnDeregister( *m_GameFramework );
+		}
+
+		void RunFrame()
+		{
+			// The collision world is gathered once per engine frame
+			++GFrameCounter;
+
+			const int32 windowFrame = m_Frame++ % loc_WindowFrames;
+			if( windowFrame == 0 )
+			{
+				m_HitboxNotify->NotifyBegin( m_Attacker->GetMesh(), nullptr, loc_ActiveFrames * loc_DeltaTime, FAnimNotifyEventReference() );
+			}
+			else if( windowFrame == loc_ActiveFrames )
+			{
+				m_HitboxNotify->NotifyEnd( m_Attacker->GetMesh(), nullptr, FAnimNotifyEventReference() );
+			}
+
+			m_Attacker->GetHitboxHandler()->TickComponent( loc_DeltaTime, LEVELTICK_All, nullptr );
+			m_CombatManager->Tick( loc_DeltaTime );
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FHitboxPathAllocationTest, "FightingGame.Combat.HitboxPathAllocations",
+                                  EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter )
+
+bool FHitboxPathAllocationTest::RunTest( const FString& Parameters )
+{
+	UWorld* world               = UWorld::CreateWorld( EWorldType::Game, false );
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext( EWorldType::Game );
+	worldContext.SetCurrentWorld( world );
+
+	FHitboxComboFixture fixture;
+	fixture.Init( world );
+
+	// The first windows size the arrays, the hitbox groups and the hit registry rows
+	for( int32 frame = 0; frame < loc_WarmUpWindows * loc_WindowFrames; ++frame )
+	{
+		fixture.RunFrame();
+	}
+
+	FHitboxAllocationCounter::BeginCounting();
+	{
+		FG_HITBOX_ALLOCATION_SCOPE();
+
+		for( int32 frame = 0; frame < loc_Frames; ++frame )
+		{
+			fixture.RunFrame();
+		}
+	}
+	uint64 allocatedBytes    = 0;
+	const uint64 allocations = FHitboxAllocationCounter::EndCounting( &allocatedBytes );
+
+	TestTrue( FString::Printf( TEXT( "No allocation over %d frames, got %llu (%llu bytes)" ), loc_Frames, allocations, allocatedBytes ), allocations == 0 );
+
+	fixture.ShutDown();
+
+	GEngine->DestroyWorldContext( world );
+	world->DestroyWorld( false );
+
+	return true;
+}
+
+#endif